@@ -0,0 +1,518 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+#include "OutputSink.h"
+
+// This header provides a streaming (out-of-core) variant of the example's distinct-and-filter
+// query for datasets, which don't fit into memory. The values are read from a source in chunks:
+// - Run phase: each chunk is filtered (the pure predicate commutes with distinct, so only the
+//   accepted values are kept), sorted and deduplicated, and written as sorted run to a temporary
+//   file.
+// - Merge phase: up to a fan-in of runs are merged with a priority queue, the duplicates across
+//   runs are dropped on the fly. As long as there are more runs than the fan-in, groups of runs
+//   are merged into longer runs (each pass reads and writes all values once); the last merge
+//   passes the values to the sink.
+// If the whole input fits into one chunk, no temporary file is written at all. The memory used is
+// bounded by the passed budget (plus a small constant per run for the run bounds): the chunk
+// takes the whole budget, and in the merge phase the budget is shared by the read buffers of the
+// merged runs and the write buffer. The values reach the sink in ascending order, so the result
+// is the same as that of the in-memory query.
+// The sources are FileSource (a binary file, e.g. written with BinaryWriter of "OutputSink.h"),
+// MappedFileSource (a binary file read via mapped views) and MemorySource (a range in memory). A
+// source is anything with a member function std::size_t read(ValueType* buffer, std::size_t
+// count), which returns the count of values read and zero at the end. I/O errors are reported
+// with std::runtime_error.
+
+
+// The smallest read buffer of a run in the merge phase in bytes. The fan-in is chosen so that the
+// buffers don't get smaller, because tiny reads would make the merge seek bound.
+const std::size_t MergeBlockBytes(1 << 16);
+
+// The largest count of runs merged at once.
+const std::size_t MaxMergeFanIn(64);
+
+// The budget used, if none is passed.
+const std::size_t DefaultMemoryBudget(64 << 20);
+
+
+// Opens a temporary binary file, which is removed when it is closed.
+inline std::FILE* openTemporaryFile()
+{
+#if defined(_MSC_VER)
+	std::FILE* file(0);
+	tmpfile_s(&file);
+#else
+	std::FILE* const file(std::tmpfile());
+#endif
+	if(!file)
+	{
+		throw std::runtime_error("Can't create a temporary file!");
+	}
+	return file;
+}
+
+
+// Moves the position of file to offset bytes from its beginning (also beyond 2GB).
+inline void seekFile(std::FILE* file, unsigned long long offset)
+{
+#if defined(_MSC_VER)
+	const int result(_fseeki64(file, static_cast<long long>(offset), SEEK_SET));
+#else
+	const int result(fseeko(file, static_cast<off_t>(offset), SEEK_SET));
+#endif
+	if(0 != result)
+	{
+		throw std::runtime_error("Can't seek in the temporary file!");
+	}
+}
+
+
+// Reads the values of the range from first to last.
+template<typename ValueType>
+class MemorySource
+{
+public:
+	MemorySource(const ValueType* first, const ValueType* last)
+		: next_(first), last_(last)
+	{
+	}
+
+	std::size_t read(ValueType* buffer, std::size_t count)
+	{
+		count = std::min(count, static_cast<std::size_t>(last_ - next_));
+		std::copy(next_, next_ + count, buffer);
+		next_ += count;
+		return count;
+	}
+
+private:
+	const ValueType* next_;
+	const ValueType* last_;
+};
+
+
+// Reads values in their binary representation from a file opened in binary mode. The file is not
+// closed by the source.
+template<typename ValueType>
+class FileSource
+{
+public:
+	explicit FileSource(std::FILE* file)
+		: file_(file)
+	{
+	}
+
+	std::size_t read(ValueType* buffer, std::size_t count)
+	{
+		const std::size_t read(std::fread(buffer, sizeof(ValueType), count, file_));
+		if(read < count && std::ferror(file_))
+		{
+			throw std::runtime_error("Can't read the input file!");
+		}
+		return read;
+	}
+
+private:
+	std::FILE* file_;
+};
+
+
+// Reads values in their binary representation from the file at path via mapped views. Only the
+// part of the file read by the current call is mapped, so files larger than the address space
+// can be read. Trailing bytes, which don't make up a whole value, are ignored.
+template<typename ValueType>
+class MappedFileSource
+{
+public:
+	explicit MappedFileSource(const char* path)
+		: size_(0), offset_(0)
+	{
+#if defined(_WIN32)
+		mapping_ = 0;
+		file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, 0);
+		LARGE_INTEGER size;
+		if(INVALID_HANDLE_VALUE == file_ || !GetFileSizeEx(file_, &size))
+		{
+			close();
+			throw std::runtime_error("Can't open the input file!");
+		}
+		size_ = static_cast<unsigned long long>(size.QuadPart);
+		// An empty file can't be mapped, but there's nothing to read anyway.
+		if(0 < size_)
+		{
+			mapping_ = CreateFileMappingA(file_, 0, PAGE_READONLY, 0, 0, 0);
+			if(!mapping_)
+			{
+				close();
+				throw std::runtime_error("Can't map the input file!");
+			}
+		}
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		granularity_ = systemInfo.dwAllocationGranularity;
+#else
+		file_ = open(path, O_RDONLY);
+		struct stat status;
+		if(-1 == file_ || 0 != fstat(file_, &status))
+		{
+			close();
+			throw std::runtime_error("Can't open the input file!");
+		}
+		size_ = static_cast<unsigned long long>(status.st_size);
+		granularity_ = static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+#endif
+		size_ -= size_ % sizeof(ValueType);
+	}
+
+	~MappedFileSource()
+	{
+		close();
+	}
+
+	std::size_t read(ValueType* buffer, std::size_t count)
+	{
+		count = static_cast<std::size_t>(std::min<unsigned long long>(count,
+			(size_ - offset_) / sizeof(ValueType)));
+		if(0 == count)
+		{
+			return 0;
+		}
+
+		// Views must start at a multiple of the allocation granularity.
+		const unsigned long long viewOffset(offset_ - offset_ % granularity_);
+		const std::size_t skipped(static_cast<std::size_t>(offset_ - viewOffset));
+		const std::size_t bytes(count * sizeof(ValueType));
+#if defined(_WIN32)
+		const void* const view(MapViewOfFile(mapping_, FILE_MAP_READ,
+			static_cast<DWORD>(viewOffset >> 32), static_cast<DWORD>(viewOffset), skipped + bytes));
+		if(!view)
+		{
+			throw std::runtime_error("Can't map a view of the input file!");
+		}
+		std::memcpy(buffer, static_cast<const char*>(view) + skipped, bytes);
+		UnmapViewOfFile(view);
+#else
+		void* const view(mmap(0, skipped + bytes, PROT_READ, MAP_PRIVATE, file_,
+			static_cast<off_t>(viewOffset)));
+		if(MAP_FAILED == view)
+		{
+			throw std::runtime_error("Can't map a view of the input file!");
+		}
+		std::memcpy(buffer, static_cast<const char*>(view) + skipped, bytes);
+		munmap(view, skipped + bytes);
+#endif
+		offset_ += bytes;
+		return count;
+	}
+
+private:
+	MappedFileSource(const MappedFileSource&);
+	MappedFileSource& operator=(const MappedFileSource&);
+
+	void close()
+	{
+#if defined(_WIN32)
+		if(mapping_)
+		{
+			CloseHandle(mapping_);
+		}
+		if(INVALID_HANDLE_VALUE != file_)
+		{
+			CloseHandle(file_);
+		}
+#else
+		if(-1 != file_)
+		{
+			::close(file_);
+		}
+#endif
+	}
+
+#if defined(_WIN32)
+	HANDLE file_;
+	HANDLE mapping_;
+#else
+	int file_;
+#endif
+	unsigned long long size_;
+	unsigned long long offset_;
+	unsigned long long granularity_;
+};
+
+
+// The position of a sorted run in a run file, counted in values.
+struct RunBounds
+{
+	unsigned long long begin;
+	unsigned long long end;
+};
+
+
+// Reads a sorted run from a run file through its own buffer. Multiple readers share the file, so
+// each refill seeks to the reader's position.
+template<typename ValueType>
+class RunReader
+{
+public:
+	RunReader(std::FILE* file, RunBounds bounds, std::size_t blockValues)
+		: file_(file), next_(bounds.begin), end_(bounds.end), block_(blockValues), current_(0),
+			filled_(0)
+	{
+		fill();
+	}
+
+	bool empty() const
+	{
+		return current_ == filled_;
+	}
+
+	const ValueType& front() const
+	{
+		return block_[current_];
+	}
+
+	void pop()
+	{
+		++current_;
+		if(current_ == filled_)
+		{
+			fill();
+		}
+	}
+
+private:
+	void fill()
+	{
+		current_ = 0;
+		filled_ = static_cast<std::size_t>(std::min<unsigned long long>(block_.size(),
+			end_ - next_));
+		if(0 < filled_)
+		{
+			seekFile(file_, next_ * sizeof(ValueType));
+			if(filled_ != std::fread(block_.data(), sizeof(ValueType), filled_, file_))
+			{
+				throw std::runtime_error("Can't read the temporary file!");
+			}
+			next_ += filled_;
+		}
+	}
+
+	std::FILE* file_;
+	unsigned long long next_;
+	unsigned long long end_;
+	std::vector<ValueType> block_;
+	std::size_t current_;
+	std::size_t filled_;
+};
+
+
+// Merges the runs from firstRun to lastRun of file, and passes each distinct value once to the
+// sink in ascending order.
+template<typename ValueType, typename SinkType>
+void mergeRunsDistinct(std::FILE* file, const RunBounds* firstRun, const RunBounds* lastRun,
+	std::size_t blockValues, SinkType& sink)
+{
+	std::vector<std::unique_ptr<RunReader<ValueType> > > readers;
+	readers.reserve(static_cast<std::size_t>(lastRun - firstRun));
+	// The heap holds the current value of each non-empty reader, the smallest comes first.
+	typedef std::pair<ValueType, std::size_t> HeadType;
+	std::priority_queue<HeadType, std::vector<HeadType>, std::greater<HeadType> > heads;
+	for(const RunBounds* run(firstRun); run != lastRun; ++run)
+	{
+		readers.push_back(std::unique_ptr<RunReader<ValueType> >(
+			new RunReader<ValueType>(file, *run, blockValues)));
+		if(!readers.back()->empty())
+		{
+			heads.push(HeadType(readers.back()->front(), readers.size() - 1));
+		}
+	}
+
+	bool hasLast(false);
+	ValueType last = ValueType();
+	while(!heads.empty())
+	{
+		const HeadType head(heads.top());
+		heads.pop();
+		if(!hasLast || last < head.first)
+		{
+			sink(head.first);
+			last = head.first;
+			hasLast = true;
+		}
+		RunReader<ValueType>& reader(*readers[head.second]);
+		reader.pop();
+		if(!reader.empty())
+		{
+			heads.push(HeadType(reader.front(), head.second));
+		}
+	}
+}
+
+
+// The sink of the intermediate merge passes: appends the values to a run file and counts them.
+template<typename ValueType>
+class RunWriterSink
+{
+public:
+	RunWriterSink(BinaryWriter<ValueType>& writer, unsigned long long& count)
+		: writer_(&writer), count_(&count)
+	{
+	}
+
+	void operator()(const ValueType& item)
+	{
+		writer_->write(item);
+		++*count_;
+	}
+
+private:
+	BinaryWriter<ValueType>* writer_;
+	unsigned long long* count_;
+};
+
+
+// Closes a temporary file, when it goes out of scope.
+class TemporaryFile
+{
+public:
+	TemporaryFile()
+		: file_(openTemporaryFile())
+	{
+	}
+
+	~TemporaryFile()
+	{
+		std::fclose(file_);
+	}
+
+	std::FILE* get() const
+	{
+		return file_;
+	}
+
+	void swap(TemporaryFile& other)
+	{
+		std::swap(file_, other.file_);
+	}
+
+private:
+	TemporaryFile(const TemporaryFile&);
+	TemporaryFile& operator=(const TemporaryFile&);
+
+	std::FILE* file_;
+};
+
+
+// Reads all values from source, and passes the distinct values accepted by predicate in ascending
+// order to the sink, using about memoryBudget bytes of memory (see above). Returns the sink (as
+// std::for_each() does).
+template<typename ValueType, typename SourceType, typename PredicateType, typename SinkType>
+SinkType externalDistinctFilter(SourceType& source, PredicateType predicate, SinkType sink,
+	std::size_t memoryBudget = DefaultMemoryBudget)
+{
+	static_assert(std::is_trivially_copyable<ValueType>::value,
+		"externalDistinctFilter() requires trivially copyable values!");
+
+	// Run phase: the chunk takes the whole budget.
+	std::vector<RunBounds> runs;
+	TemporaryFile runFile;
+	{
+		std::vector<ValueType> chunk(std::max<std::size_t>(1, memoryBudget / sizeof(ValueType)));
+		unsigned long long written(0);
+		bool atEnd(false);
+		while(!atEnd)
+		{
+			// A source may return fewer values than requested before its end, so the chunk is
+			// refilled until it is full or the source returns zero.
+			std::size_t read(0);
+			while(read < chunk.size())
+			{
+				const std::size_t count(source.read(chunk.data() + read, chunk.size() - read));
+				if(0 == count)
+				{
+					atEnd = true;
+					break;
+				}
+				read += count;
+			}
+			if(0 == read)
+			{
+				break;
+			}
+			const auto acceptedEnd(std::remove_if(chunk.begin(), chunk.begin() + read,
+				[&predicate](const ValueType& item){return !predicate(item);}));
+			std::sort(chunk.begin(), acceptedEnd);
+			const auto distinctEnd(std::unique(chunk.begin(), acceptedEnd));
+			const std::size_t count(static_cast<std::size_t>(distinctEnd - chunk.begin()));
+
+			// The whole input fits into one chunk, so this is the result.
+			if(runs.empty() && atEnd)
+			{
+				std::for_each(chunk.begin(), distinctEnd, std::ref(sink));
+				return sink;
+			}
+
+			if(count != std::fwrite(chunk.data(), sizeof(ValueType), count, runFile.get()))
+			{
+				throw std::runtime_error("Can't write the temporary file!");
+			}
+			const RunBounds run = {written, written + count};
+			runs.push_back(run);
+			written += count;
+		}
+		if(0 != std::fflush(runFile.get()))
+		{
+			throw std::runtime_error("Can't write the temporary file!");
+		}
+	}
+
+	// Merge phase: the budget is shared by the fan-in read buffers and one write buffer.
+	const std::size_t fanIn(std::max<std::size_t>(2, std::min(MaxMergeFanIn,
+		memoryBudget / MergeBlockBytes)));
+	const std::size_t blockValues(std::max<std::size_t>(1,
+		memoryBudget / ((fanIn + 1) * sizeof(ValueType))));
+	while(fanIn < runs.size())
+	{
+		std::vector<RunBounds> mergedRuns;
+		TemporaryFile mergedFile;
+		{
+			BinaryWriter<ValueType> writer(mergedFile.get(), blockValues * sizeof(ValueType));
+			unsigned long long written(0);
+			for(std::size_t run(0); run < runs.size(); run += fanIn)
+			{
+				const std::size_t lastRun(std::min(runs.size(), run + fanIn));
+				const unsigned long long begin(written);
+				RunWriterSink<ValueType> runSink(writer, written);
+				mergeRunsDistinct<ValueType>(runFile.get(), runs.data() + run,
+					runs.data() + lastRun, blockValues, runSink);
+				const RunBounds mergedRun = {begin, written};
+				mergedRuns.push_back(mergedRun);
+			}
+		}
+		if(0 != std::ferror(mergedFile.get()))
+		{
+			throw std::runtime_error("Can't write the temporary file!");
+		}
+		runs.swap(mergedRuns);
+		runFile.swap(mergedFile);
+	}
+	mergeRunsDistinct<ValueType>(runFile.get(), runs.data(), runs.data() + runs.size(),
+		blockValues, sink);
+	return sink;
+}
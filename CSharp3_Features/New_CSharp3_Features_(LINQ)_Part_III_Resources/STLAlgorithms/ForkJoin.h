@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// This header provides the simple fork/join scheme the parallel algorithms of this example are
+// built on: a task is called for each index on its own thread, and the caller waits for all of
+// them. The tasks must not throw (as with any function running on a std::thread).
+
+
+// Returns the count of threads to use for workItems independent pieces of work, if threadCount
+// threads were requested (zero means one thread per hardware thread). At least one thread is used.
+inline unsigned effectiveThreadCount(unsigned threadCount, std::size_t workItems)
+{
+	if(0 == threadCount)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	return static_cast<unsigned>(std::max<std::size_t>(1,
+		std::min<std::size_t>(threadCount, workItems)));
+}
+
+
+// Calls task(index) for each index from zero to taskCount on its own thread, the calling thread
+// runs the last task itself. Returns when all tasks are done.
+template<typename TaskType>
+void forkJoin(unsigned taskCount, TaskType task)
+{
+	if(0 == taskCount)
+	{
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(taskCount - 1);
+	for(unsigned index(0); index < taskCount - 1; ++index)
+	{
+		threads.push_back(std::thread(task, index));
+	}
+	task(taskCount - 1);
+	for(auto iter(threads.begin()); iter != threads.end(); ++iter)
+	{
+		iter->join();
+	}
+}
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// This header provides output stages for the results of the example's query. Writing each value
+// with std::cout<<item<<std::endl flushes the stream after every value, so for millions of values
+// the output dominates the runtime. Instead:
+// - BufferedTextWriter formats integers with a small table of digit pairs (like std::to_chars()
+//   does) into a large buffer, which is written with one fwrite() when it is full.
+// - BinaryWriter writes the values in their binary representation (native byte order), so
+//   downstream tools can read them without parsing text.
+// - writeMapped() writes a range of values to a binary file via a memory mapped view of the file,
+//   and falls back to BinaryWriter, if the file can't be mapped.
+// - TemporaryFileName names a new file in the directory for temporary files and removes it again,
+//   so writeMapped() doesn't leave files behind.
+// The writers can't be copied, because they own their buffer. Sinks are passed by value (e.g. to
+// std::for_each()), so sinkTo() yields a sink, which only refers to a writer.
+
+
+// The size of the buffers of the writers in bytes.
+const std::size_t OutputBufferSize(1 << 16);
+
+// The longest text of an integer: the digits of a 64-bit value and a sign.
+const std::size_t MaxIntegerChars(21);
+
+
+// Writes the decimal digits of value backwards, so that they end before last. Returns the
+// position of the first digit.
+inline char* formatDigitsBackwards(char* last, unsigned long long value)
+{
+	static const char DigitPairs[] =
+		"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+		"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	while(100 <= value)
+	{
+		const unsigned pair(static_cast<unsigned>(value % 100) * 2);
+		value /= 100;
+		*--last = DigitPairs[pair + 1];
+		*--last = DigitPairs[pair];
+	}
+	if(10 <= value)
+	{
+		const unsigned pair(static_cast<unsigned>(value) * 2);
+		*--last = DigitPairs[pair + 1];
+		*--last = DigitPairs[pair];
+	}
+	else
+	{
+		*--last = static_cast<char>('0' + value);
+	}
+	return last;
+}
+
+
+// Writes the decimal text of value to the range from first to last (without terminating zero).
+// Returns the end of the text, or null if the range is too small (as std::to_chars() does, with
+// the error reported as null).
+template<typename IntegerType>
+char* toChars(char* first, char* last, IntegerType value)
+{
+	static_assert(std::is_integral<IntegerType>::value, "toChars() requires integral values!");
+
+	char digits[MaxIntegerChars];
+	char* const digitsEnd(digits + MaxIntegerChars);
+	char* digitsBegin;
+	// Negate as unsigned, so that the smallest value doesn't overflow.
+	if(value < 0)
+	{
+		digitsBegin = formatDigitsBackwards(digitsEnd,
+			0 - static_cast<unsigned long long>(static_cast<long long>(value)));
+		*--digitsBegin = '-';
+	}
+	else
+	{
+		digitsBegin = formatDigitsBackwards(digitsEnd, static_cast<unsigned long long>(value));
+	}
+
+	const std::size_t length(static_cast<std::size_t>(digitsEnd - digitsBegin));
+	if(static_cast<std::size_t>(last - first) < length)
+	{
+		return 0;
+	}
+	std::memcpy(first, digitsBegin, length);
+	return first + length;
+}
+
+
+// Writes integers as decimal text, each followed by separator, to a file (e.g. stdout). The text
+// is written when the buffer is full, when flush() is called and when the writer is destroyed.
+class BufferedTextWriter
+{
+public:
+	explicit BufferedTextWriter(std::FILE* file, char separator = '\n',
+		std::size_t bufferSize = OutputBufferSize)
+		: file_(file), separator_(separator),
+			buffer_(bufferSize < MaxIntegerChars + 1 ? MaxIntegerChars + 1 : bufferSize), used_(0)
+	{
+	}
+
+	~BufferedTextWriter()
+	{
+		flush();
+	}
+
+	template<typename IntegerType>
+	void write(IntegerType value)
+	{
+		if(buffer_.size() - used_ < MaxIntegerChars + 1)
+		{
+			writeBuffer();
+		}
+		char* const begin(buffer_.data() + used_);
+		char* const end(toChars(begin, buffer_.data() + buffer_.size(), value));
+		*end = separator_;
+		used_ += static_cast<std::size_t>(end - begin) + 1;
+	}
+
+	// Writes the buffered text and flushes the file. Call it before writing to the file by other
+	// means (e.g. std::cout for stdout).
+	void flush()
+	{
+		writeBuffer();
+		std::fflush(file_);
+	}
+
+private:
+	BufferedTextWriter(const BufferedTextWriter&);
+	BufferedTextWriter& operator=(const BufferedTextWriter&);
+
+	void writeBuffer()
+	{
+		if(0 < used_)
+		{
+			std::fwrite(buffer_.data(), 1, used_, file_);
+			used_ = 0;
+		}
+	}
+
+	std::FILE* file_;
+	char separator_;
+	std::vector<char> buffer_;
+	std::size_t used_;
+};
+
+
+// Writes values of ValueType in their binary representation to a file, which should be opened in
+// binary mode. The values are written when the buffer is full, when flush() is called and when the
+// writer is destroyed.
+template<typename ValueType>
+class BinaryWriter
+{
+public:
+	static_assert(std::is_trivially_copyable<ValueType>::value,
+		"BinaryWriter requires trivially copyable values!");
+
+	explicit BinaryWriter(std::FILE* file, std::size_t bufferSize = OutputBufferSize)
+		: file_(file), buffer_(bufferSize < sizeof(ValueType) ? 1 : bufferSize / sizeof(ValueType)),
+			used_(0)
+	{
+	}
+
+	~BinaryWriter()
+	{
+		flush();
+	}
+
+	void write(const ValueType& value)
+	{
+		if(buffer_.size() == used_)
+		{
+			writeBuffer();
+		}
+		buffer_[used_] = value;
+		++used_;
+	}
+
+	// Writes the count values starting at first, large ranges bypass the buffer.
+	void write(const ValueType* first, std::size_t count)
+	{
+		if(buffer_.size() - used_ < count)
+		{
+			writeBuffer();
+			if(buffer_.size() < count)
+			{
+				std::fwrite(first, sizeof(ValueType), count, file_);
+				return;
+			}
+		}
+		std::copy(first, first + count, buffer_.begin() + used_);
+		used_ += count;
+	}
+
+	void flush()
+	{
+		writeBuffer();
+		std::fflush(file_);
+	}
+
+private:
+	BinaryWriter(const BinaryWriter&);
+	BinaryWriter& operator=(const BinaryWriter&);
+
+	void writeBuffer()
+	{
+		if(0 < used_)
+		{
+			std::fwrite(buffer_.data(), sizeof(ValueType), used_, file_);
+			used_ = 0;
+		}
+	}
+
+	std::FILE* file_;
+	std::vector<ValueType> buffer_;
+	std::size_t used_;
+};
+
+
+// The sink passing each value to a writer, which must outlive the sink.
+template<typename WriterType>
+class WriterSink
+{
+public:
+	explicit WriterSink(WriterType& writer)
+		: writer_(&writer)
+	{
+	}
+
+	template<typename T>
+	void operator()(const T& item)
+	{
+		writer_->write(item);
+	}
+
+private:
+	WriterType* writer_;
+};
+
+
+// Yields a sink writing to writer, e.g. std::for_each(first, last, sinkTo(writer)).
+template<typename WriterType>
+WriterSink<WriterType> sinkTo(WriterType& writer)
+{
+	return WriterSink<WriterType>(writer);
+}
+
+
+// Copies the bytes to a new file at path via a memory mapped view. Returns false, if the file
+// can't be created or mapped.
+inline bool writeMappedBytes(const char* path, const void* bytes, std::size_t size)
+{
+#if defined(_WIN32)
+	const HANDLE file(CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, 0));
+	if(INVALID_HANDLE_VALUE == file)
+	{
+		return false;
+	}
+	bool written(0 == size);
+	if(!written)
+	{
+		const unsigned long long mappingSize(size);
+		const HANDLE mapping(CreateFileMappingA(file, 0, PAGE_READWRITE,
+			static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize), 0));
+		if(mapping)
+		{
+			void* const view(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+			if(view)
+			{
+				std::memcpy(view, bytes, size);
+				written = FALSE != FlushViewOfFile(view, 0);
+				UnmapViewOfFile(view);
+			}
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+	return written;
+#else
+	const int file(open(path, O_RDWR | O_CREAT | O_TRUNC, 0644));
+	if(-1 == file)
+	{
+		return false;
+	}
+	bool written(0 == size);
+	if(!written && 0 == ftruncate(file, static_cast<off_t>(size)))
+	{
+		void* const view(mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0));
+		if(MAP_FAILED != view)
+		{
+			std::memcpy(view, bytes, size);
+			written = 0 == msync(view, size, MS_SYNC);
+			munmap(view, size);
+		}
+	}
+	close(file);
+	return written;
+#endif
+}
+
+
+// Writes the values from first to last in their binary representation to a new file at path. The
+// file is written via a memory mapped view, if this fails, it is written with a BinaryWriter.
+// Returns false, if the file couldn't be written at all.
+template<typename ValueType>
+bool writeMapped(const char* path, const ValueType* first, const ValueType* last)
+{
+	static_assert(std::is_trivially_copyable<ValueType>::value,
+		"writeMapped() requires trivially copyable values!");
+
+	const std::size_t count(static_cast<std::size_t>(last - first));
+	if(count <= std::numeric_limits<std::size_t>::max() / sizeof(ValueType)
+		&& writeMappedBytes(path, first, count * sizeof(ValueType)))
+	{
+		return true;
+	}
+
+#if defined(_MSC_VER)
+	std::FILE* file(0);
+	fopen_s(&file, path, "wb");
+#else
+	std::FILE* const file(std::fopen(path, "wb"));
+#endif
+	if(!file)
+	{
+		return false;
+	}
+	{
+		BinaryWriter<ValueType> writer(file);
+		writer.write(first, count);
+	}
+	const bool written(0 == std::ferror(file));
+	return 0 == std::fclose(file) && written;
+}
+
+
+// A new empty file with a unique name in the directory for temporary files, which is removed with
+// the object. If the file can't be created, path() is empty, so writing to it fails.
+class TemporaryFileName
+{
+public:
+	TemporaryFileName()
+	{
+#if defined(_WIN32)
+		char directory[MAX_PATH];
+		char path[MAX_PATH];
+		const DWORD length(GetTempPathA(MAX_PATH, directory));
+		if(0 < length && length < MAX_PATH && 0 != GetTempFileNameA(directory, "stl", 0, path))
+		{
+			path_ = path;
+		}
+#else
+		const char* const directory(std::getenv("TMPDIR"));
+		std::string pattern(directory && *directory ? directory : "/tmp");
+		pattern += "/stlXXXXXX";
+		std::vector<char> path(pattern.begin(), pattern.end());
+		path.push_back('\0');
+		const int file(mkstemp(&path[0]));
+		if(-1 != file)
+		{
+			close(file);
+			path_ = &path[0];
+		}
+#endif
+	}
+
+	~TemporaryFileName()
+	{
+		if(!path_.empty())
+		{
+			std::remove(path_.c_str());
+		}
+	}
+
+	const char* path() const
+	{
+		return path_.c_str();
+	}
+
+private:
+	TemporaryFileName(const TemporaryFileName&);
+	TemporaryFileName& operator=(const TemporaryFileName&);
+
+	std::string path_;
+};
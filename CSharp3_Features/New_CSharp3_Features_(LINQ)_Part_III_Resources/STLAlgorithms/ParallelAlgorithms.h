@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "ForkJoin.h"
+
+// This header provides parallel variants of the sort -> unique -> stable_partition chain of the
+// example. Each stage divides its range into one chunk per thread (see "ForkJoin.h"):
+// - parallelSort() sorts the chunks, then merges pairs of sorted runs until one run is left. The
+//   merges of each round are split among all threads along the "merge path", so that every
+//   thread produces an equal share of the output.
+// - parallelUniqueCopy() counts the first elements of each group of equal values per chunk, the
+//   prefix sum of the counts yields the position where each chunk writes its values.
+// - parallelStablePartitionCopy() does the same for the values accepted and rejected by the
+//   predicate. The predicate is evaluated in blocks into an array of flags, this simple loop can
+//   be vectorized by the compiler.
+// The parallel stages can't work in place, they use one scratch buffer of the size of the range.
+// With a thread count of one the plain std algorithms are called, so the same call serves as
+// serial baseline. Predicates are called concurrently, so they must not modify shared state.
+
+
+// Ranges smaller than this are not worth to be processed by another thread.
+const std::size_t ParallelGrainSize(1 << 14);
+
+// The count of predicate results evaluated in one block.
+const std::size_t PredicateBlockSize(256);
+
+
+// Returns the bounds of chunkCount chunks of nearly equal size dividing size items.
+inline std::vector<std::size_t> chunkBounds(std::size_t size, unsigned chunkCount)
+{
+	std::vector<std::size_t> bounds(chunkCount + 1);
+	for(unsigned chunk(0); chunk <= chunkCount; ++chunk)
+	{
+		bounds[chunk] = static_cast<std::size_t>(
+			static_cast<unsigned long long>(size) * chunk / chunkCount);
+	}
+	return bounds;
+}
+
+
+// Returns the count of items taken from the sorted range first (of length firstSize), when the
+// first outputCount items of merging it with the sorted range second (of length secondSize) are
+// produced by std::merge().
+template<typename RandomAccessIteratorType>
+std::size_t mergePathSplit(RandomAccessIteratorType first, std::size_t firstSize,
+	RandomAccessIteratorType second, std::size_t secondSize, std::size_t outputCount)
+{
+	std::size_t low(outputCount > secondSize ? outputCount - secondSize : 0);
+	std::size_t high(std::min(outputCount, firstSize));
+	while(low < high)
+	{
+		const std::size_t taken(low + (high - low) / 2);
+		// std::merge() takes the item of the first range on equal items.
+		if(!(second[outputCount - taken - 1] < first[taken]))
+		{
+			low = taken + 1;
+		}
+		else
+		{
+			high = taken;
+		}
+	}
+	return low;
+}
+
+
+// Merges the sorted runs of source (delimited by bounds) pairwise into destination, using
+// threadCount threads. bounds is updated to the bounds of the merged runs.
+template<typename SourceIteratorType, typename DestinationIteratorType>
+void mergeRuns(SourceIteratorType source, DestinationIteratorType destination,
+	std::vector<std::size_t>& bounds, unsigned threadCount)
+{
+	const std::size_t runCount(bounds.size() - 1);
+	const std::size_t pairCount((runCount + 1) / 2);
+	const unsigned workersPerPair(static_cast<unsigned>(std::max<std::size_t>(1,
+		threadCount / pairCount)));
+
+	forkJoin(static_cast<unsigned>(pairCount * workersPerPair), [&](unsigned task)
+	{
+		const std::size_t pair(task / workersPerPair);
+		const unsigned worker(task % workersPerPair);
+		const std::size_t low(bounds[2 * pair]);
+		const std::size_t middle(bounds[std::min(2 * pair + 1, runCount)]);
+		const std::size_t high(bounds[std::min(2 * pair + 2, runCount)]);
+
+		// The share of the merged output this worker produces.
+		const std::size_t outputBegin((high - low) * worker / workersPerPair);
+		const std::size_t outputEnd((high - low) * (worker + 1) / workersPerPair);
+		const std::size_t firstBegin(mergePathSplit(source + low, middle - low, source + middle,
+			high - middle, outputBegin));
+		const std::size_t firstEnd(mergePathSplit(source + low, middle - low, source + middle,
+			high - middle, outputEnd));
+		std::merge(source + low + firstBegin, source + low + firstEnd,
+			source + middle + (outputBegin - firstBegin), source + middle + (outputEnd - firstEnd),
+			destination + low + outputBegin);
+	});
+
+	std::vector<std::size_t> mergedBounds;
+	mergedBounds.reserve(pairCount + 1);
+	for(std::size_t run(0); run < runCount; run += 2)
+	{
+		mergedBounds.push_back(bounds[run]);
+	}
+	mergedBounds.push_back(bounds[runCount]);
+	bounds.swap(mergedBounds);
+}
+
+
+// Sorts the range from first to last with threadCount threads (zero means one thread per
+// hardware thread). scratch must provide room for the whole range.
+template<typename RandomAccessIteratorType, typename ScratchIteratorType>
+void parallelSort(RandomAccessIteratorType first, RandomAccessIteratorType last,
+	ScratchIteratorType scratch, unsigned threadCount)
+{
+	const auto size(static_cast<std::size_t>(std::distance(first, last)));
+	const unsigned threads(effectiveThreadCount(threadCount, size / ParallelGrainSize));
+	if(1 == threads)
+	{
+		std::sort(first, last);
+		return;
+	}
+
+	std::vector<std::size_t> bounds(chunkBounds(size, threads));
+	forkJoin(threads, [&](unsigned chunk)
+	{
+		std::sort(first + bounds[chunk], first + bounds[chunk + 1]);
+	});
+
+	// Merge the runs back and forth between the range and the scratch buffer.
+	bool inScratch(false);
+	while(2 < bounds.size())
+	{
+		if(inScratch)
+		{
+			mergeRuns(scratch, first, bounds, threads);
+		}
+		else
+		{
+			mergeRuns(first, scratch, bounds, threads);
+		}
+		inScratch = !inScratch;
+	}
+
+	if(inScratch)
+	{
+		const std::vector<std::size_t> copyBounds(chunkBounds(size, threads));
+		forkJoin(threads, [&](unsigned chunk)
+		{
+			std::copy(scratch + copyBounds[chunk], scratch + copyBounds[chunk + 1],
+				first + copyBounds[chunk]);
+		});
+	}
+}
+
+
+// Copies the first item of each group of equal items of the sorted range from first to last to
+// destination (as std::unique_copy() does) with threadCount threads. Returns the end of the
+// destination range.
+template<typename RandomAccessIteratorType, typename OutputIteratorType>
+OutputIteratorType parallelUniqueCopy(RandomAccessIteratorType first,
+	RandomAccessIteratorType last, OutputIteratorType destination, unsigned threadCount)
+{
+	const auto size(static_cast<std::size_t>(std::distance(first, last)));
+	const unsigned threads(effectiveThreadCount(threadCount, size / ParallelGrainSize));
+	if(1 == threads)
+	{
+		return std::unique_copy(first, last, destination);
+	}
+
+	const std::vector<std::size_t> bounds(chunkBounds(size, threads));
+	std::vector<std::size_t> offsets(threads + 1);
+	forkJoin(threads, [&](unsigned chunk)
+	{
+		std::size_t heads(0);
+		for(std::size_t i(bounds[chunk]); i < bounds[chunk + 1]; ++i)
+		{
+			heads += (0 == i || !(first[i - 1] == first[i])) ? 1 : 0;
+		}
+		offsets[chunk + 1] = heads;
+	});
+	for(unsigned chunk(0); chunk < threads; ++chunk)
+	{
+		offsets[chunk + 1] += offsets[chunk];
+	}
+
+	forkJoin(threads, [&](unsigned chunk)
+	{
+		auto output(destination + offsets[chunk]);
+		for(std::size_t i(bounds[chunk]); i < bounds[chunk + 1]; ++i)
+		{
+			if(0 == i || !(first[i - 1] == first[i]))
+			{
+				*output = first[i];
+				++output;
+			}
+		}
+	});
+	return destination + offsets[threads];
+}
+
+
+// Evaluates predicate for the count items starting at first into flags, and returns the count of
+// accepted items.
+template<typename RandomAccessIteratorType, typename PredicateType>
+std::size_t evaluateBlock(RandomAccessIteratorType first, std::size_t count,
+	PredicateType& predicate, unsigned char* flags)
+{
+	for(std::size_t i(0); i < count; ++i)
+	{
+		flags[i] = predicate(first[i]) ? 1 : 0;
+	}
+	std::size_t accepted(0);
+	for(std::size_t i(0); i < count; ++i)
+	{
+		accepted += flags[i];
+	}
+	return accepted;
+}
+
+
+// Copies the items of the range from first to last, which are accepted by predicate, to
+// destination followed by the rejected items, both keeping their relative order (like
+// std::stable_partition() does in place) with threadCount threads. Returns the end of the
+// accepted items in the destination range.
+template<typename RandomAccessIteratorType, typename OutputIteratorType, typename PredicateType>
+OutputIteratorType parallelStablePartitionCopy(RandomAccessIteratorType first,
+	RandomAccessIteratorType last, OutputIteratorType destination, PredicateType predicate,
+	unsigned threadCount)
+{
+	const auto size(static_cast<std::size_t>(std::distance(first, last)));
+	const unsigned threads(effectiveThreadCount(threadCount, size / ParallelGrainSize));
+	const std::vector<std::size_t> bounds(chunkBounds(size, threads));
+
+	// Count the accepted items per chunk.
+	std::vector<std::size_t> acceptedOffsets(threads + 1);
+	forkJoin(threads, [&](unsigned chunk)
+	{
+		unsigned char flags[PredicateBlockSize];
+		std::size_t accepted(0);
+		for(std::size_t block(bounds[chunk]); block < bounds[chunk + 1];
+			block += PredicateBlockSize)
+		{
+			accepted += evaluateBlock(first + block,
+				std::min(PredicateBlockSize, bounds[chunk + 1] - block), predicate, flags);
+		}
+		acceptedOffsets[chunk + 1] = accepted;
+	});
+	for(unsigned chunk(0); chunk < threads; ++chunk)
+	{
+		acceptedOffsets[chunk + 1] += acceptedOffsets[chunk];
+	}
+	const std::size_t acceptedCount(acceptedOffsets[threads]);
+
+	// Scatter the items, the rejected items of a chunk follow all accepted items.
+	forkJoin(threads, [&](unsigned chunk)
+	{
+		unsigned char flags[PredicateBlockSize];
+		auto accepted(destination + acceptedOffsets[chunk]);
+		auto rejected(destination + acceptedCount + (bounds[chunk] - acceptedOffsets[chunk]));
+		for(std::size_t block(bounds[chunk]); block < bounds[chunk + 1];
+			block += PredicateBlockSize)
+		{
+			const std::size_t count(std::min(PredicateBlockSize, bounds[chunk + 1] - block));
+			evaluateBlock(first + block, count, predicate, flags);
+			for(std::size_t i(0); i < count; ++i)
+			{
+				if(flags[i])
+				{
+					*accepted = first[block + i];
+					++accepted;
+				}
+				else
+				{
+					*rejected = first[block + i];
+					++rejected;
+				}
+			}
+		}
+	});
+	return destination + acceptedCount;
+}
+
+
+// Runs the example's chain (sort, unique and stable_partition) on the range from first to last
+// with threadCount threads. Returns the end of the sorted distinct values accepted by predicate,
+// which start at first. As with the chain the rest of the range is rearranged.
+template<typename RandomAccessIteratorType, typename PredicateType>
+RandomAccessIteratorType parallelDistinctFilter(RandomAccessIteratorType first,
+	RandomAccessIteratorType last, PredicateType predicate, unsigned threadCount)
+{
+	typedef typename std::iterator_traits<RandomAccessIteratorType>::value_type ValueType;
+
+	const auto size(static_cast<std::size_t>(std::distance(first, last)));
+	const unsigned threads(effectiveThreadCount(threadCount, size / ParallelGrainSize));
+	if(1 == threads)
+	{
+		std::sort(first, last);
+		const auto newEnd(std::unique(first, last));
+		return std::stable_partition(first, newEnd, predicate);
+	}
+
+	std::vector<ValueType> scratch(size);
+	parallelSort(first, last, scratch.begin(), threads);
+	const auto scratchEnd(parallelUniqueCopy(first, last, scratch.begin(), threads));
+	return parallelStablePartitionCopy(scratch.begin(), scratchEnd, first, predicate, threads);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+
+#include "ForkJoin.h"
+
+// This header provides a parallel variant of filling a range with random values, i.e. of
+// std::generate() with a distribution bound to a std::mt19937. A single engine can't be shared by
+// multiple threads, and its sequence can't be split cheaply. So the range is divided into blocks
+// of a fixed size, and each block gets its own engine, which is seeded from the seed and the
+// index of the block (via std::seed_seq). The threads work on contiguous runs of blocks.
+// Because the engine of a block only depends on the seed and the block's index, the result is
+// reproducible for a fixed seed, and it is even the same for any count of threads. (But it is not
+// the sequence a single engine would produce.)
+
+
+// The count of values generated with the same engine.
+const std::size_t GenerateBlockSize(1 << 16);
+
+
+// Fills the block with the passed index, which starts at blockBegin, with values drawn from its
+// own engine.
+template<typename EngineType, typename RandomAccessIteratorType, typename DistributionType>
+void generateBlock(RandomAccessIteratorType blockBegin, RandomAccessIteratorType blockEnd,
+	DistributionType distribution, unsigned seed, std::size_t blockIndex)
+{
+	std::seed_seq sequence{seed, static_cast<unsigned>(blockIndex),
+		static_cast<unsigned>(static_cast<unsigned long long>(blockIndex) >> 32)};
+	EngineType engine(sequence);
+	for(auto iter(blockBegin); iter != blockEnd; ++iter)
+	{
+		*iter = distribution(engine);
+	}
+}
+
+
+// Fills the blocks with the indexes from firstBlock to lastBlock of the range starting at first.
+template<typename EngineType, typename RandomAccessIteratorType, typename DistributionType>
+void generateBlocks(RandomAccessIteratorType first, RandomAccessIteratorType last,
+	DistributionType distribution, unsigned seed, std::size_t firstBlock, std::size_t lastBlock)
+{
+	const auto size(static_cast<std::size_t>(std::distance(first, last)));
+	for(std::size_t blockIndex(firstBlock); blockIndex < lastBlock; ++blockIndex)
+	{
+		const std::size_t blockBegin(blockIndex * GenerateBlockSize);
+		const std::size_t blockEnd(std::min(size, blockBegin + GenerateBlockSize));
+		generateBlock<EngineType>(first + blockBegin, first + blockEnd, distribution, seed,
+			blockIndex);
+	}
+}
+
+
+// Fills the range from first to last with values drawn from distribution using threadCount
+// threads (zero means one thread per hardware thread). The result only depends on seed.
+template<typename EngineType, typename RandomAccessIteratorType, typename DistributionType>
+void parallelGenerate(RandomAccessIteratorType first, RandomAccessIteratorType last,
+	DistributionType distribution, unsigned seed, unsigned threadCount)
+{
+	const auto size(static_cast<std::size_t>(std::distance(first, last)));
+	const std::size_t blockCount((size + GenerateBlockSize - 1) / GenerateBlockSize);
+	const unsigned threads(effectiveThreadCount(threadCount, blockCount));
+	forkJoin(threads, [&](unsigned thread)
+	{
+		generateBlocks<EngineType>(first, last, distribution, seed,
+			blockCount * thread / threads, blockCount * (thread + 1) / threads);
+	});
+}
+
+
+// The same as above using a std::mt19937 as engine, like the example does.
+template<typename RandomAccessIteratorType, typename DistributionType>
+void parallelGenerate(RandomAccessIteratorType first, RandomAccessIteratorType last,
+	DistributionType distribution, unsigned seed, unsigned threadCount)
+{
+	parallelGenerate<std::mt19937>(first, last, distribution, seed, threadCount);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SmallDomainDistinct.h"
+
+// This header provides a lazily composed pipeline for queries of the form
+// generate -> distinct -> filter -> sink. Calling distinct() or filter() does not touch any data,
+// it only yields a new pipeline type that records the requested stages. The work is done in
+// run(). There the stages are fused, so that the data is walked as few times as possible:
+// - The filter is applied while generating, because a pure (value-only) predicate commutes with
+//   distinct. Only the accepted values are stored, this makes the following stages cheaper.
+// - Without distinct stage the accepted values are passed to the sink directly, no storage is
+//   needed at all.
+// - With distinct stage the accepted values are sorted in place, and the duplicates are skipped
+//   while passing the sorted values to the sink. So std::unique() and std::stable_partition() (and
+//   the temporary buffer of the latter) are not needed anymore.
+// - With distinct stage over a known small domain of integers (see "SmallDomainDistinct.h") the
+//   accepted values are only marked in a bitset while generating, so the whole query needs one
+//   pass and no buffer.
+// The only storage is the caller's buffer, which is sized once before the pipeline starts.
+
+
+// The neutral predicate used by a pipeline without filter stage.
+struct AcceptAll
+{
+	template<typename T>
+	bool operator()(const T&) const
+	{
+		return true;
+	}
+};
+
+
+// The conjunction of two predicates, it is used when filter() is called more than once.
+template<typename FirstPredicateType, typename SecondPredicateType>
+class BothPredicates
+{
+public:
+	BothPredicates(FirstPredicateType first, SecondPredicateType second)
+		: first_(first), second_(second)
+	{
+	}
+
+	template<typename T>
+	bool operator()(const T& item) const
+	{
+		return first_(item) && second_(item);
+	}
+
+private:
+	FirstPredicateType first_;
+	SecondPredicateType second_;
+};
+
+
+// The pipeline type. GeneratorType is a nullary functor producing the values, PredicateType is the
+// (pure) filter and IsDistinct tells, whether only distinct values reach the sink.
+template<typename GeneratorType, typename PredicateType = AcceptAll, bool IsDistinct = false>
+class Pipeline
+{
+public:
+	typedef typename std::decay<decltype(std::declval<GeneratorType&>()())>::type ValueType;
+
+	Pipeline(GeneratorType generator, std::size_t count,
+		PredicateType predicate = PredicateType(), bool hasDomain = false,
+		ValueType lower = ValueType(), ValueType upper = ValueType())
+		: generator_(generator), count_(count), predicate_(predicate), hasDomain_(hasDomain),
+			lower_(lower), upper_(upper)
+	{
+	}
+
+	// Yields a pipeline, which only passes distinct values (in ascending order) to the sink.
+	Pipeline<GeneratorType, PredicateType, true> distinct() const
+	{
+		return Pipeline<GeneratorType, PredicateType, true>(generator_, count_, predicate_);
+	}
+
+	// Yields a pipeline like distinct(), but the generator is known to only produce integers in
+	// [lower, upper] (e.g. the bounds of its std::uniform_int_distribution). If the domain is
+	// small enough, the duplicates are found with a bitset instead of sorting.
+	Pipeline<GeneratorType, PredicateType, true> distinct(ValueType lower, ValueType upper) const
+	{
+		static_assert(std::is_integral<ValueType>::value,
+			"distinct(lower, upper) requires integral values!");
+		return Pipeline<GeneratorType, PredicateType, true>(generator_, count_, predicate_, true,
+			lower, upper);
+	}
+
+	// Yields a pipeline, which only passes the values accepted by predicate to the sink. The
+	// predicate must only depend on the passed value.
+	template<typename NewPredicateType>
+	Pipeline<GeneratorType, BothPredicates<PredicateType, NewPredicateType>, IsDistinct>
+		filter(NewPredicateType predicate) const
+	{
+		return Pipeline<GeneratorType, BothPredicates<PredicateType, NewPredicateType>,
+			IsDistinct>(generator_, count_,
+				BothPredicates<PredicateType, NewPredicateType>(predicate_, predicate),
+				hasDomain_, lower_, upper_);
+	}
+
+	// Runs the pipeline and passes the resulting values to sink. The passed buffer is used as
+	// storage for the distinct stage, afterwards it contains the accepted values. Returns the sink
+	// (as std::for_each() does).
+	template<typename SinkType>
+	SinkType run(std::vector<ValueType>& buffer, SinkType sink)
+	{
+		return runCore(buffer, sink, std::integral_constant<bool, IsDistinct>());
+	}
+
+private:
+	template<typename SinkType>
+	SinkType runCore(std::vector<ValueType>&, SinkType sink, std::false_type)
+	{
+		// Generate, filter and sink in one pass.
+		for(std::size_t i(0); i < count_; ++i)
+		{
+			const ValueType item(generator_());
+			if(predicate_(item))
+			{
+				sink(item);
+			}
+		}
+		return sink;
+	}
+
+	template<typename SinkType>
+	SinkType runCore(std::vector<ValueType>& buffer, SinkType sink, std::true_type)
+	{
+		if(hasDomain_)
+		{
+			return runDomain(buffer, sink, std::is_integral<ValueType>());
+		}
+		return runSorted(buffer, sink);
+	}
+
+	template<typename SinkType>
+	SinkType runDomain(std::vector<ValueType>& buffer, SinkType sink, std::false_type)
+	{
+		return runSorted(buffer, sink);
+	}
+
+	template<typename SinkType>
+	SinkType runDomain(std::vector<ValueType>& buffer, SinkType sink, std::true_type)
+	{
+		if(!isSmallDomain(lower_, upper_, count_))
+		{
+			return runSorted(buffer, sink);
+		}
+
+		// Generate, filter and mark in one pass, then emit the marked values.
+		DomainBitsType seen;
+		for(std::size_t i(0); i < count_; ++i)
+		{
+			const ValueType item(generator_());
+			assert(!(item < lower_) && !(upper_ < item) && "The generator left the domain!");
+			if(predicate_(item))
+			{
+				seen.set(static_cast<std::size_t>(domainOffset(lower_, item)));
+			}
+		}
+		return sinkDomain(seen, lower_, upper_, sink);
+	}
+
+	template<typename SinkType>
+	SinkType runSorted(std::vector<ValueType>& buffer, SinkType sink)
+	{
+		if(buffer.size() < count_)
+		{
+			buffer.resize(count_);
+		}
+
+		// Generate and filter in one pass, the accepted values are compacted to the front.
+		const auto begin(buffer.begin());
+		auto end(begin);
+		for(std::size_t i(0); i < count_; ++i)
+		{
+			const ValueType item(generator_());
+			if(predicate_(item))
+			{
+				*end = item;
+				++end;
+			}
+		}
+
+		// Sort in place, then skip the duplicates while sinking in one pass.
+		return distinctFilterSorted(begin, end, AcceptAll(), sink);
+	}
+
+	GeneratorType generator_;
+	std::size_t count_;
+	PredicateType predicate_;
+	bool hasDomain_;
+	ValueType lower_;
+	ValueType upper_;
+};
+
+
+// Starts a pipeline, which draws count values from generator.
+template<typename GeneratorType>
+Pipeline<GeneratorType> generate(GeneratorType generator, std::size_t count)
+{
+	return Pipeline<GeneratorType>(generator, count);
+}
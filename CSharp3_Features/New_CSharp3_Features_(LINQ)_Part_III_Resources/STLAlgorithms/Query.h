@@ -0,0 +1,445 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "SmallDomainDistinct.h"
+
+// This header provides query operators in the style of LINQ to objects, so the query of the
+// example can be written as chain like in C#3:
+//   from(list).distinct().where(isEven).select(square).forEach(sink)
+// As in C# the execution is deferred: from() only refers to the container, and distinct(),
+// where() and select() don't touch any data, they only yield a new query type, which has the
+// previous query and the new operator as template arguments. The work is done by the terminal
+// operations forEach(), count() and toVector(). There the container is walked once, and each
+// value is pushed through all operators, which the compiler has fused into one loop body: there
+// are no intermediate containers and no std::function (or other virtual) calls.
+// - where() passes the accepted values, select() passes the projected values to the next
+//   operator.
+// - distinct() keeps the values in the order of their first occurrence (as Enumerable.Distinct()
+//   does), the values seen are put into a hash set.
+// - distinct(lower, upper) does the same for integers from a known small domain (e.g. the bounds
+//   of a std::uniform_int_distribution), the values seen are marked in a bitset (see
+//   "SmallDomainDistinct.h"). Values outside of the domain are put into a hash set.
+// The state of distinct() lives only during a terminal operation, so a query can be run again,
+// e.g. after the container has been changed.
+
+
+// The operator adapters below refer to the next stage of the query (the downstream sink), they
+// only live during a terminal operation.
+
+// Passes the values accepted by the predicate to the downstream sink.
+template<typename PredicateType, typename SinkType>
+class WhereSink
+{
+public:
+	WhereSink(const PredicateType& predicate, SinkType& sink)
+		: predicate_(predicate), sink_(sink)
+	{
+	}
+
+	template<typename T>
+	void operator()(const T& item)
+	{
+		if(predicate_(item))
+		{
+			sink_(item);
+		}
+	}
+
+private:
+	WhereSink& operator=(const WhereSink&);
+
+	const PredicateType& predicate_;
+	SinkType& sink_;
+};
+
+
+// Passes the projected values to the downstream sink.
+template<typename SelectorType, typename SinkType>
+class SelectSink
+{
+public:
+	SelectSink(const SelectorType& selector, SinkType& sink)
+		: selector_(selector), sink_(sink)
+	{
+	}
+
+	template<typename T>
+	void operator()(const T& item)
+	{
+		sink_(selector_(item));
+	}
+
+private:
+	SelectSink& operator=(const SelectSink&);
+
+	const SelectorType& selector_;
+	SinkType& sink_;
+};
+
+
+// Passes the first occurrence of each value to the downstream sink.
+template<typename ValueType, typename SinkType>
+class DistinctSink
+{
+public:
+	explicit DistinctSink(SinkType& sink)
+		: sink_(sink)
+	{
+	}
+
+	void operator()(const ValueType& item)
+	{
+		if(seen_.insert(item).second)
+		{
+			sink_(item);
+		}
+	}
+
+private:
+	DistinctSink(const DistinctSink&);
+	DistinctSink& operator=(const DistinctSink&);
+
+	std::unordered_set<ValueType> seen_;
+	SinkType& sink_;
+};
+
+
+// Like DistinctSink, but the values of the domain [lower, upper] are marked in a bitset.
+template<typename ValueType, typename SinkType>
+class DomainDistinctSink
+{
+public:
+	DomainDistinctSink(ValueType lower, ValueType upper, SinkType& sink)
+		: lower_(lower), domainSize_(static_cast<std::size_t>(domainOffset(lower, upper)) + 1),
+			sink_(sink)
+	{
+	}
+
+	void operator()(const ValueType& item)
+	{
+		const auto offset(domainOffset(lower_, item));
+		if(offset < domainSize_)
+		{
+			if(!seen_.test(static_cast<std::size_t>(offset)))
+			{
+				seen_.set(static_cast<std::size_t>(offset));
+				sink_(item);
+			}
+		}
+		else if(outliers_.insert(item).second)
+		{
+			sink_(item);
+		}
+	}
+
+private:
+	DomainDistinctSink(const DomainDistinctSink&);
+	DomainDistinctSink& operator=(const DomainDistinctSink&);
+
+	ValueType lower_;
+	std::size_t domainSize_;
+	DomainBitsType seen_;
+	std::unordered_set<ValueType> outliers_;
+	SinkType& sink_;
+};
+
+
+// Collects the values in a std::vector.
+template<typename ValueType>
+class VectorSink
+{
+public:
+	explicit VectorSink(std::vector<ValueType>& values)
+		: values_(&values)
+	{
+	}
+
+	void operator()(const ValueType& item)
+	{
+		values_->push_back(item);
+	}
+
+private:
+	std::vector<ValueType>* values_;
+};
+
+
+// Counts the values.
+class CountSink
+{
+public:
+	CountSink()
+		: count_(0)
+	{
+	}
+
+	template<typename T>
+	void operator()(const T&)
+	{
+		++count_;
+	}
+
+	std::size_t count() const
+	{
+		return count_;
+	}
+
+private:
+	std::size_t count_;
+};
+
+
+// The sources of a query. Each source provides its ValueType and push(), which passes all its
+// values to a sink.
+
+// The values of a range of iterators.
+template<typename IteratorType>
+class RangeSource
+{
+public:
+	typedef typename std::iterator_traits<IteratorType>::value_type ValueType;
+
+	RangeSource(IteratorType first, IteratorType last)
+		: first_(first), last_(last)
+	{
+	}
+
+	template<typename SinkType>
+	void push(SinkType& sink) const
+	{
+		for(IteratorType iter(first_); iter != last_; ++iter)
+		{
+			sink(*iter);
+		}
+	}
+
+private:
+	IteratorType first_;
+	IteratorType last_;
+};
+
+
+// The values of a container, its range is only taken when the query is run.
+template<typename ContainerType>
+class ContainerSource
+{
+public:
+	typedef typename ContainerType::value_type ValueType;
+
+	explicit ContainerSource(const ContainerType& container)
+		: container_(&container)
+	{
+	}
+
+	template<typename SinkType>
+	void push(SinkType& sink) const
+	{
+		RangeSource<typename ContainerType::const_iterator>(container_->begin(), container_->end())
+			.push(sink);
+	}
+
+private:
+	const ContainerType* container_;
+};
+
+
+// The values of the upstream source accepted by the predicate.
+template<typename UpstreamType, typename PredicateType>
+class WhereSource
+{
+public:
+	typedef typename UpstreamType::ValueType ValueType;
+
+	WhereSource(const UpstreamType& upstream, PredicateType predicate)
+		: upstream_(upstream), predicate_(predicate)
+	{
+	}
+
+	template<typename SinkType>
+	void push(SinkType& sink) const
+	{
+		WhereSink<PredicateType, SinkType> whereSink(predicate_, sink);
+		upstream_.push(whereSink);
+	}
+
+private:
+	UpstreamType upstream_;
+	PredicateType predicate_;
+};
+
+
+// The values of the upstream source projected by the selector.
+template<typename UpstreamType, typename SelectorType>
+class SelectSource
+{
+public:
+	typedef typename std::decay<decltype(std::declval<const SelectorType&>()(
+		std::declval<const typename UpstreamType::ValueType&>()))>::type ValueType;
+
+	SelectSource(const UpstreamType& upstream, SelectorType selector)
+		: upstream_(upstream), selector_(selector)
+	{
+	}
+
+	template<typename SinkType>
+	void push(SinkType& sink) const
+	{
+		SelectSink<SelectorType, SinkType> selectSink(selector_, sink);
+		upstream_.push(selectSink);
+	}
+
+private:
+	UpstreamType upstream_;
+	SelectorType selector_;
+};
+
+
+// The first occurrences of the values of the upstream source.
+template<typename UpstreamType>
+class DistinctSource
+{
+public:
+	typedef typename UpstreamType::ValueType ValueType;
+
+	explicit DistinctSource(const UpstreamType& upstream)
+		: upstream_(upstream)
+	{
+	}
+
+	template<typename SinkType>
+	void push(SinkType& sink) const
+	{
+		DistinctSink<ValueType, SinkType> distinctSink(sink);
+		upstream_.push(distinctSink);
+	}
+
+private:
+	UpstreamType upstream_;
+};
+
+
+// The first occurrences of the values of the upstream source from a known domain.
+template<typename UpstreamType>
+class DomainDistinctSource
+{
+public:
+	typedef typename UpstreamType::ValueType ValueType;
+
+	DomainDistinctSource(const UpstreamType& upstream, ValueType lower, ValueType upper)
+		: upstream_(upstream), lower_(lower), upper_(upper)
+	{
+	}
+
+	template<typename SinkType>
+	void push(SinkType& sink) const
+	{
+		// A domain too large for the bitset is handled by the hash set alone.
+		if(upper_ < lower_ || SmallDomainLimit <= domainOffset(lower_, upper_))
+		{
+			DistinctSink<ValueType, SinkType> distinctSink(sink);
+			upstream_.push(distinctSink);
+			return;
+		}
+		DomainDistinctSink<ValueType, SinkType> distinctSink(lower_, upper_, sink);
+		upstream_.push(distinctSink);
+	}
+
+private:
+	UpstreamType upstream_;
+	ValueType lower_;
+	ValueType upper_;
+};
+
+
+// The query type, it provides the operators and the terminal operations on top of a source.
+template<typename SourceType>
+class Query
+{
+public:
+	typedef typename SourceType::ValueType ValueType;
+
+	explicit Query(const SourceType& source)
+		: source_(source)
+	{
+	}
+
+	// Yields a query, which only passes the first occurrence of each value.
+	Query<DistinctSource<SourceType> > distinct() const
+	{
+		return Query<DistinctSource<SourceType> >(DistinctSource<SourceType>(source_));
+	}
+
+	// Yields a query like distinct(), but the values are expected to be integers from the domain
+	// [lower, upper], so the values seen can be marked in a bitset.
+	Query<DomainDistinctSource<SourceType> > distinct(ValueType lower, ValueType upper) const
+	{
+		static_assert(std::is_integral<ValueType>::value,
+			"distinct(lower, upper) requires integral values!");
+		return Query<DomainDistinctSource<SourceType> >(
+			DomainDistinctSource<SourceType>(source_, lower, upper));
+	}
+
+	// Yields a query, which only passes the values accepted by predicate.
+	template<typename PredicateType>
+	Query<WhereSource<SourceType, PredicateType> > where(PredicateType predicate) const
+	{
+		return Query<WhereSource<SourceType, PredicateType> >(
+			WhereSource<SourceType, PredicateType>(source_, predicate));
+	}
+
+	// Yields a query, which passes the results of selector applied to the values.
+	template<typename SelectorType>
+	Query<SelectSource<SourceType, SelectorType> > select(SelectorType selector) const
+	{
+		return Query<SelectSource<SourceType, SelectorType> >(
+			SelectSource<SourceType, SelectorType>(source_, selector));
+	}
+
+	// Runs the query and passes the resulting values to sink. Returns the sink (as std::for_each()
+	// does).
+	template<typename SinkType>
+	SinkType forEach(SinkType sink) const
+	{
+		source_.push(sink);
+		return sink;
+	}
+
+	// Runs the query and returns the count of the resulting values.
+	std::size_t count() const
+	{
+		return forEach(CountSink()).count();
+	}
+
+	// Runs the query and returns the resulting values.
+	std::vector<ValueType> toVector() const
+	{
+		std::vector<ValueType> values;
+		forEach(VectorSink<ValueType>(values));
+		return values;
+	}
+
+private:
+	SourceType source_;
+};
+
+
+// Starts a query over the values of container, which must outlive the query.
+template<typename ContainerType>
+Query<ContainerSource<ContainerType> > from(const ContainerType& container)
+{
+	return Query<ContainerSource<ContainerType> >(ContainerSource<ContainerType>(container));
+}
+
+
+// Starts a query over the values of the range from first to last.
+template<typename IteratorType>
+Query<RangeSource<IteratorType> > from(IteratorType first, IteratorType last)
+{
+	return Query<RangeSource<IteratorType> >(RangeSource<IteratorType>(first, last));
+}
@@ -1,11 +1,20 @@
 #include "stdafx.h"
 
-#include <iostream>
 #include <vector>
 #include <algorithm>
 #include <random>
 #include <functional>
 #include <iterator>
+#include <thread>
+
+#include "ExternalDistinct.h"
+#include "OutputSink.h"
+#include "ParallelAlgorithms.h"
+#include "ParallelGenerate.h"
+#include "Pipeline.h"
+#include "Query.h"
+#include "SimdFilter.h"
+#include "SmallDomainDistinct.h"
 
 // Test
 
@@ -47,13 +56,96 @@ int _tmain(int argc, _TCHAR* argv[])
 		[](int item){return 0 == item % 2;}));
 
 	// Finally we can output the unique and filtered values to the console. We have to remember to
-	// pass the new end iterator in order to only output the range with the filtered values.
-	std::for_each(list.begin(), newEnd2, [](int item){std::cout<<item<<std::endl;});
+	// pass the new end iterator in order to only output the range with the filtered values. -
+	// Writing each value with std::cout<<item<<std::endl would flush the stream after every value,
+	// the BufferedTextWriter (see "OutputSink.h") collects the text in a large buffer instead and
+	// writes it in one go.
+	BufferedTextWriter output(stdout);
+	std::for_each(list.begin(), newEnd2, sinkTo(output));
 
 	// Phew!
 	// That was a lot of work, because although the C++ syntax has been streamlined, it's
 	// needed to perform many independent and error prone operations to get the result. But, on
 	// the other hand, this code doesn't use any loop or explicit type or function declaration.
 	// C#3 provides another solution: extension methods and method chaining!
+
+	// Sidebar: Each of the operations above walks the whole container again, and
+	// std::stable_partition() even allocates a temporary buffer. The lazy pipeline (see
+	// "Pipeline.h") describes the same query as a chain of stages, and fuses the stages when it is
+	// run: the values are generated and filtered in one pass, then sorted, and finally the
+	// duplicates are skipped while the values are passed to the sink. The container is only used as
+	// storage for the distinct stage. - As we know the domain of the distribution, the duplicates
+	// can even be found with a bitset instead of sorting (see "SmallDomainDistinct.h"), then the
+	// whole query needs just one pass.
+	std::vector<int> pipelineList;
+	generate(std::bind(distribution, engine), 10)
+		.distinct(distribution.a(), distribution.b())
+		.filter([](int item){return 0 == item % 2;})
+		.run(pipelineList, sinkTo(output));
+
+	// Sidebar: The query operators (see "Query.h") allow chaining the operations like in C#3. The
+	// chain is only composed by from(), distinct() and where(), forEach() runs it: the container
+	// is walked once, and each value passes all operations, there are no intermediate containers.
+	// Other than the chain above, distinct() keeps the values in the order of their first
+	// occurrence, as Enumerable.Distinct() does.
+	std::vector<int> queryList(10);
+	std::generate(queryList.begin(), queryList.end(), std::bind(distribution, engine));
+	from(queryList)
+		.distinct()
+		.where([](int item){return 0 == item % 2;})
+		.forEach(sinkTo(output));
+
+	// Sidebar: For large containers filling the container with random values is the slowest part.
+	// parallelGenerate() (see "ParallelGenerate.h") fills the container with multiple threads, the
+	// result only depends on the seed. I.e. it is reproducible, regardless of the count of
+	// threads.
+	std::vector<int> largeList(1000000);
+	parallelGenerate(largeList.begin(), largeList.end(), distribution, 42,
+		std::thread::hardware_concurrency());
+	distinctFilter(largeList.begin(), largeList.end(), distribution.a(), distribution.b(),
+		[](int item){return 0 == item % 2;}, sinkTo(output));
+
+	// Sidebar: The sort/unique/stable_partition chain can also run on all cores with
+	// parallelDistinctFilter() (see "ParallelAlgorithms.h"). Passing one thread runs the serial
+	// chain from above, so both can be compared easily.
+	const auto largeEnd(parallelDistinctFilter(largeList.begin(), largeList.end(),
+		[](int item){return 0 == item % 2;}, std::thread::hardware_concurrency()));
+	std::for_each(largeList.begin(), largeEnd, sinkTo(output));
+
+	// Sidebar: For ints and simple predicates (like parity or ranges) the filter step can be
+	// vectorized with compactIf() (see "SimdFilter.h"), which keeps the relative order like
+	// std::stable_partition() does, but doesn't need a temporary buffer.
+	std::vector<int> simdList(1000000);
+	parallelGenerate(simdList.begin(), simdList.end(), distribution, 42, 0);
+	std::sort(simdList.begin(), simdList.end());
+	const auto uniqueEnd(std::unique(simdList.begin(), simdList.end()));
+	int* const simdEnd(compactIf(simdList.data(), simdList.data() + (uniqueEnd - simdList.begin()),
+		IntPredicate::even()));
+	std::for_each(simdList.data(), simdEnd, sinkTo(output));
+	output.flush();
+
+	// Sidebar: Downstream tools can read the result without parsing text, if it is written in its
+	// binary representation, here via a memory mapped file (a temporary one, which is removed
+	// again).
+	{
+		const TemporaryFileName resultFile;
+		writeMapped(resultFile.path(), simdList.data(), simdEnd);
+	}
+
+	// Sidebar: If the values don't fit into memory, externalDistinctFilter() (see
+	// "ExternalDistinct.h") streams them from a file in chunks, which are sorted into runs on
+	// disk and merged afterwards. The memory used is bounded by the passed budget, here 1MB for
+	// 4MB of values. The input file is a temporary one, which is removed after the source has
+	// been closed.
+	std::vector<int> streamList(1000000);
+	parallelGenerate(streamList.begin(), streamList.end(), distribution, 42, 0);
+	{
+		const TemporaryFileName inputFile;
+		writeMapped(inputFile.path(), streamList.data(), streamList.data() + streamList.size());
+		MappedFileSource<int> source(inputFile.path());
+		externalDistinctFilter<int>(source, [](int item){return 0 == item % 2;}, sinkTo(output),
+			1 << 20);
+	}
+	output.flush();
 	return EXIT_SUCCESS;
 }
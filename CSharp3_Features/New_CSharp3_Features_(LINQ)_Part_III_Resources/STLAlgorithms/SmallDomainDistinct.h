@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// This header provides a distinct-and-filter kernel for integers from a small, known domain
+// [lower, upper], like the values drawn from a std::uniform_int_distribution. Instead of sorting
+// the values in O(n log n) to find the duplicates, the accepted values are marked in a bitset in
+// one pass. Afterwards the bitset is scanned from lower to upper, so the distinct values are
+// emitted in ascending order in O(n + k), where k is the size of the domain.
+// If the domain is too large (the bitset lives on the stack, and scanning it would cost more than
+// sorting) the kernel falls back to the comparison-sort path.
+
+
+// The largest domain the bitset path handles (8KB of bits).
+const std::size_t SmallDomainLimit(1 << 16);
+
+// The bitset type used to mark the values seen.
+typedef std::bitset<SmallDomainLimit> DomainBitsType;
+
+
+// Returns the offset of item in the domain starting at lower. The unsigned arithmetic can't
+// overflow, even if the domain spans the whole range of T.
+template<typename T>
+typename std::make_unsigned<T>::type domainOffset(T lower, T item)
+{
+	typedef typename std::make_unsigned<T>::type UnsignedType;
+	return static_cast<UnsignedType>(static_cast<UnsignedType>(item)
+		- static_cast<UnsignedType>(lower));
+}
+
+
+// Checks, whether the bitset path pays off for count values from the domain [lower, upper]. Next
+// to the limit of the bitset, the domain must not be much larger than the count of values,
+// otherwise scanning the bitset would dominate.
+template<typename T>
+bool isSmallDomain(T lower, T upper, std::size_t count)
+{
+	static_assert(std::is_integral<T>::value, "The domain's type must be integral!");
+
+	if(upper < lower)
+	{
+		return false;
+	}
+	const auto domainSize(static_cast<unsigned long long>(domainOffset(lower, upper)) + 1);
+	return domainSize <= SmallDomainLimit && domainSize / 16 <= count;
+}
+
+
+// Passes the values marked in seen to the sink in ascending order.
+template<typename T, typename SinkType>
+SinkType sinkDomain(const DomainBitsType& seen, T lower, T upper, SinkType sink)
+{
+	const std::size_t domainSize(static_cast<std::size_t>(domainOffset(lower, upper)) + 1);
+	for(std::size_t offset(0); offset < domainSize; ++offset)
+	{
+		if(seen.test(offset))
+		{
+			sink(static_cast<T>(lower + static_cast<T>(offset)));
+		}
+	}
+	return sink;
+}
+
+
+// The comparison-sort path: sorts the range and passes each accepted value once to the sink.
+template<typename RandomAccessIteratorType, typename PredicateType, typename SinkType>
+SinkType distinctFilterSorted(RandomAccessIteratorType first, RandomAccessIteratorType last,
+	PredicateType predicate, SinkType sink)
+{
+	std::sort(first, last);
+	for(auto iter(first); iter != last; ++iter)
+	{
+		if((iter == first || *(iter - 1) < *iter) && predicate(*iter))
+		{
+			sink(*iter);
+		}
+	}
+	return sink;
+}
+
+
+// Passes the distinct values of the range from first to last, which are accepted by predicate, in
+// ascending order to the sink. The values are expected to lie in [lower, upper]; if the domain is
+// small enough the range is only read once and left untouched. Otherwise (or if a value outside
+// of the domain is found) the range is sorted as with std::sort().
+template<typename RandomAccessIteratorType, typename PredicateType, typename SinkType>
+SinkType distinctFilter(RandomAccessIteratorType first, RandomAccessIteratorType last,
+	typename std::iterator_traits<RandomAccessIteratorType>::value_type lower,
+	typename std::iterator_traits<RandomAccessIteratorType>::value_type upper,
+	PredicateType predicate, SinkType sink)
+{
+	if(isSmallDomain(lower, upper, static_cast<std::size_t>(std::distance(first, last))))
+	{
+		DomainBitsType seen;
+		auto iter(first);
+		for(; iter != last; ++iter)
+		{
+			if(*iter < lower || upper < *iter)
+			{
+				break;
+			}
+			if(predicate(*iter))
+			{
+				seen.set(static_cast<std::size_t>(domainOffset(lower, *iter)));
+			}
+		}
+		if(iter == last)
+		{
+			return sinkDomain(seen, lower, upper, sink);
+		}
+	}
+	return distinctFilterSorted(first, last, predicate, sink);
+}
@@ -0,0 +1,503 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <chrono>
+#include <sys/resource.h>
+#endif
+
+#include "ExternalDistinct.h"
+#include "OutputSink.h"
+#include "ParallelAlgorithms.h"
+#include "ParallelGenerate.h"
+#include "Pipeline.h"
+#include "Query.h"
+#include "SimdFilter.h"
+#include "SmallDomainDistinct.h"
+
+// This benchmark runs the query of the STLAlgorithm example (the distinct, even values of a
+// container filled with random ints) and its optimized variants for sizes from 10 to
+// 10^maxExponent. For each variant and size it reports the wall time of each stage, the
+// throughput (elements per second) and the peak resident memory of the process so far. This peak
+// never decreases, so it includes the peaks of the variants run before. The results are written
+// as JSON to stdout, so redirect the output to keep them:
+//   STLAlgorithmsBenchmark.exe [maxExponent=9] [threads=0 (all)] [upper=9] > results.json
+// The values are drawn from [1, upper] like in the example, a large upper bound makes sort and
+// unique do real work. Sizes, which can't be allocated (e.g. 10^9 ints in a 32-bit process), are
+// reported with an error. The serial variant is the example's chain, and the baseline for all
+// other variants. The output variants run the same chain, but write the results to a temporary
+// file: flushing after each value (like std::endl), buffered as text or buffered binary. Use a
+// large upper bound to get many results. The external variant streams the values from a file
+// with a memory budget of an eighth of the values' size.
+// The query variants walk the generated container once with the query operators (see
+// "Query.h"), their results come in the order of the first occurrence instead of ascending.
+
+
+// The accumulated seconds of the stages of a variant, in the order the stages are run.
+typedef std::vector<std::pair<const char*, double> > StageTimesType;
+
+// The signature of a variant: runs the query over list (which has the size of the benchmark) and
+// records the stages' times. Returns the count of values reaching the sink.
+typedef std::size_t (*VariantType)(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned threadCount,
+	StageTimesType& stages);
+
+
+// Returns the seconds elapsed since an arbitrary point in time.
+double now()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+// Returns the peak resident memory (working set) of the process in bytes so far.
+unsigned long long peakResidentBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+		? static_cast<unsigned long long>(counters.PeakWorkingSetSize)
+		: 0;
+#else
+	rusage usage;
+	return 0 == getrusage(RUSAGE_SELF, &usage)
+		? static_cast<unsigned long long>(usage.ru_maxrss) * 1024
+		: 0;
+#endif
+}
+
+
+// Writes text as JSON string, quotes, backslashes and control characters are escaped.
+void printJsonString(const char* text)
+{
+	std::putchar('"');
+	for(const char* iter(text); *iter; ++iter)
+	{
+		const unsigned char character(static_cast<unsigned char>(*iter));
+		if('"' == character || '\\' == character)
+		{
+			std::printf("\\%c", character);
+		}
+		else if(character < 0x20)
+		{
+			std::printf("\\u%04x", character);
+		}
+		else
+		{
+			std::putchar(character);
+		}
+	}
+	std::putchar('"');
+}
+
+
+// Measures the stages of one run of a variant. Each call of lap() ends the current stage. When
+// a variant is run repeatedly, the times of the same stages are accumulated.
+class StageClock
+{
+public:
+	explicit StageClock(StageTimesType& stages)
+		: stages_(stages), stage_(0), last_(now())
+	{
+	}
+
+	void lap(const char* name)
+	{
+		const double current(now());
+		if(stage_ < stages_.size())
+		{
+			stages_[stage_].second += current - last_;
+		}
+		else
+		{
+			stages_.push_back(std::make_pair(name, current - last_));
+		}
+		++stage_;
+		last_ = now();
+	}
+
+private:
+	StageTimesType& stages_;
+	std::size_t stage_;
+	double last_;
+};
+
+
+// The sink of all variants: counts the values (the output is not part of this benchmark).
+class CountingSink
+{
+public:
+	explicit CountingSink(std::size_t& count)
+		: count_(&count)
+	{
+	}
+
+	void operator()(int)
+	{
+		++*count_;
+	}
+
+private:
+	std::size_t* count_;
+};
+
+
+bool isEven(int item)
+{
+	return 0 == item % 2;
+}
+
+
+// The stages of the example's chain: generate, sort, unique and stable_partition. Returns the end
+// of the results.
+std::vector<int>::iterator runChain(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, StageClock& clock)
+{
+	const std::mt19937 engine;
+	auto generator(std::bind(distribution, engine));
+	std::generate(list.begin(), list.end(), [&generator](){return generator();});
+	clock.lap("generate");
+	std::sort(list.begin(), list.end());
+	clock.lap("sort");
+	const auto newEnd(std::unique(list.begin(), list.end()));
+	clock.lap("unique");
+	const auto newEnd2(std::stable_partition(list.begin(), newEnd, isEven));
+	clock.lap("partition");
+	return newEnd2;
+}
+
+
+// The example's chain.
+std::size_t runSerial(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const auto newEnd2(runChain(list, distribution, clock));
+	std::size_t count(0);
+	std::for_each(list.begin(), newEnd2, CountingSink(count));
+	clock.lap("sink");
+	return count;
+}
+
+
+// The fused pipeline sorting the accepted values (see "Pipeline.h").
+std::size_t runPipeline(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const std::mt19937 engine;
+	std::size_t count(0);
+	generate(std::bind(distribution, engine), list.size())
+		.distinct()
+		.filter(isEven)
+		.run(list, CountingSink(count));
+	clock.lap("run");
+	return count;
+}
+
+
+// The fused pipeline with the bitset kernel for the distribution's domain (see
+// "SmallDomainDistinct.h").
+std::size_t runPipelineDomain(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const std::mt19937 engine;
+	std::size_t count(0);
+	generate(std::bind(distribution, engine), list.size())
+		.distinct(distribution.a(), distribution.b())
+		.filter(isEven)
+		.run(list, CountingSink(count));
+	clock.lap("run");
+	return count;
+}
+
+
+// The query operators over the generated container (see "Query.h"), distinct() with a hash set.
+std::size_t runQuery(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const std::mt19937 engine;
+	std::generate(list.begin(), list.end(), std::bind(distribution, engine));
+	clock.lap("generate");
+	std::size_t count(0);
+	from(list)
+		.distinct()
+		.where(isEven)
+		.forEach(CountingSink(count));
+	clock.lap("run");
+	return count;
+}
+
+
+// The query operators with distinct() over the distribution's domain.
+std::size_t runQueryDomain(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const std::mt19937 engine;
+	std::generate(list.begin(), list.end(), std::bind(distribution, engine));
+	clock.lap("generate");
+	std::size_t count(0);
+	from(list)
+		.distinct(distribution.a(), distribution.b())
+		.where(isEven)
+		.forEach(CountingSink(count));
+	clock.lap("run");
+	return count;
+}
+
+
+// The parallel stages (see "ParallelGenerate.h" and "ParallelAlgorithms.h").
+std::size_t runParallel(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned threadCount,
+	StageTimesType& stages)
+{
+	StageClock clock(stages);
+	parallelGenerate(list.begin(), list.end(), distribution, 0, threadCount);
+	clock.lap("generate");
+	std::vector<int> scratch(list.size());
+	parallelSort(list.begin(), list.end(), scratch.begin(), threadCount);
+	clock.lap("sort");
+	const auto scratchEnd(parallelUniqueCopy(list.begin(), list.end(), scratch.begin(),
+		threadCount));
+	clock.lap("unique");
+	const auto newEnd(parallelStablePartitionCopy(scratch.begin(), scratchEnd, list.begin(),
+		isEven, threadCount));
+	clock.lap("partition");
+	std::size_t count(0);
+	std::for_each(list.begin(), newEnd, CountingSink(count));
+	clock.lap("sink");
+	return count;
+}
+
+
+// The example's chain with the vectorized filter (see "SimdFilter.h").
+std::size_t runSimd(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const std::mt19937 engine;
+	auto generator(std::bind(distribution, engine));
+	std::generate(list.begin(), list.end(), [&generator](){return generator();});
+	clock.lap("generate");
+	std::sort(list.begin(), list.end());
+	clock.lap("sort");
+	const auto newEnd(std::unique(list.begin(), list.end()));
+	clock.lap("unique");
+	int* const newEnd2(compactIf(list.data(), list.data() + (newEnd - list.begin()),
+		IntPredicate::even()));
+	clock.lap("filter");
+	std::size_t count(0);
+	std::for_each(list.data(), newEnd2, CountingSink(count));
+	clock.lap("sink");
+	return count;
+}
+
+
+// The example's chain writing each result as text and flushing the file after it, as
+// std::cout<<item<<std::endl does.
+std::size_t runOutputFlushed(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const auto newEnd2(runChain(list, distribution, clock));
+	std::FILE* const file(openTemporaryFile());
+	std::for_each(list.begin(), newEnd2, [file](int item)
+	{
+		std::fprintf(file, "%d\n", item);
+		std::fflush(file);
+	});
+	std::fclose(file);
+	clock.lap("output");
+	return static_cast<std::size_t>(newEnd2 - list.begin());
+}
+
+
+// The example's chain writing the results with a BufferedTextWriter (see "OutputSink.h").
+std::size_t runOutputText(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const auto newEnd2(runChain(list, distribution, clock));
+	std::FILE* const file(openTemporaryFile());
+	{
+		BufferedTextWriter writer(file);
+		std::for_each(list.begin(), newEnd2, sinkTo(writer));
+	}
+	std::fclose(file);
+	clock.lap("output");
+	return static_cast<std::size_t>(newEnd2 - list.begin());
+}
+
+
+// The example's chain writing the results with a BinaryWriter (see "OutputSink.h").
+std::size_t runOutputBinary(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const auto newEnd2(runChain(list, distribution, clock));
+	std::FILE* const file(openTemporaryFile());
+	{
+		BinaryWriter<int> writer(file);
+		writer.write(list.data(), static_cast<std::size_t>(newEnd2 - list.begin()));
+	}
+	std::fclose(file);
+	clock.lap("output");
+	return static_cast<std::size_t>(newEnd2 - list.begin());
+}
+
+
+// The streaming variant (see "ExternalDistinct.h"): the values are written to a temporary file,
+// which is read back in chunks of an eighth of its size, so that sorted runs have to be merged.
+std::size_t runExternal(std::vector<int>& list,
+	const std::uniform_int_distribution<int>& distribution, unsigned, StageTimesType& stages)
+{
+	StageClock clock(stages);
+	const std::mt19937 engine;
+	auto generator(std::bind(distribution, engine));
+	std::generate(list.begin(), list.end(), [&generator](){return generator();});
+	clock.lap("generate");
+	TemporaryFile input;
+	{
+		BinaryWriter<int> writer(input.get());
+		writer.write(list.data(), list.size());
+	}
+	std::rewind(input.get());
+	clock.lap("write");
+	std::size_t count(0);
+	FileSource<int> source(input.get());
+	externalDistinctFilter<int>(source, isEven, CountingSink(count),
+		std::max<std::size_t>(1, list.size() * sizeof(int) / 8));
+	clock.lap("external");
+	return count;
+}
+
+
+// Runs variant on size elements (repeatedly for small sizes) and writes the result as JSON
+// object. Returns false, if the variant failed (e.g. the size could not be allocated).
+bool benchmark(const char* name, VariantType variant, std::size_t size,
+	const std::uniform_int_distribution<int>& distribution, unsigned threadCount, bool first)
+{
+	const std::size_t repetitions(std::max<std::size_t>(1, 1000000 / size));
+	StageTimesType stages;
+	std::size_t resultCount(0);
+
+	std::printf("%s    {\"variant\": \"%s\", \"size\": %llu, ", first ? "" : ",\n", name,
+		static_cast<unsigned long long>(size));
+	try
+	{
+		std::vector<int> list(size);
+		for(std::size_t repetition(0); repetition < repetitions; ++repetition)
+		{
+			resultCount = variant(list, distribution, threadCount, stages);
+		}
+	}
+	catch(const std::bad_alloc&)
+	{
+		std::printf("\"error\": \"out of memory\"}");
+		return false;
+	}
+	catch(const std::exception& exception)
+	{
+		std::printf("\"error\": ");
+		printJsonString(exception.what());
+		std::printf("}");
+		return false;
+	}
+
+	double totalSeconds(0);
+	std::printf("\"repetitions\": %llu, \"stages\": {",
+		static_cast<unsigned long long>(repetitions));
+	for(auto iter(stages.begin()); iter != stages.end(); ++iter)
+	{
+		const double seconds(iter->second / repetitions);
+		totalSeconds += seconds;
+		std::printf("%s\"%s\": %.9f", iter == stages.begin() ? "" : ", ", iter->first, seconds);
+	}
+	std::printf("}, \"totalSeconds\": %.9f, \"elementsPerSecond\": %.1f, "
+		"\"processPeakResidentBytes\": %llu, \"resultCount\": %llu}", totalSeconds,
+		0 < totalSeconds ? size / totalSeconds : 0.0, peakResidentBytes(),
+		static_cast<unsigned long long>(resultCount));
+	std::fflush(stdout);
+	return true;
+}
+
+
+int _tmain(int argc, _TCHAR* argv[])
+{
+	const int maxExponent(1 < argc ? _ttoi(argv[1]) : 9);
+	const unsigned threadCount(2 < argc ? static_cast<unsigned>(_ttoi(argv[2])) : 0);
+	const int upper(3 < argc ? _ttoi(argv[3]) : 9);
+	const std::uniform_int_distribution<int> distribution(1, std::max(1, upper));
+
+	const std::pair<const char*, VariantType> variants[] =
+	{
+		std::make_pair("serial", &runSerial),
+		std::make_pair("pipeline", &runPipeline),
+		std::make_pair("pipelineDomain", &runPipelineDomain),
+		std::make_pair("query", &runQuery),
+		std::make_pair("queryDomain", &runQueryDomain),
+		std::make_pair("parallel", &runParallel),
+		std::make_pair("simd", &runSimd),
+		std::make_pair("outputFlushed", &runOutputFlushed),
+		std::make_pair("outputText", &runOutputText),
+		std::make_pair("outputBinary", &runOutputBinary),
+		std::make_pair("external", &runExternal)
+	};
+	const std::size_t variantCount(sizeof(variants) / sizeof(variants[0]));
+	bool allocatable[variantCount];
+	std::fill(allocatable, allocatable + variantCount, true);
+
+	std::printf("{\n  \"benchmark\": \"STLAlgorithms\",\n  \"threads\": %u,\n"
+		"  \"domain\": [%d, %d],\n  \"avx2\": %s,\n  \"results\": [\n",
+		effectiveThreadCount(threadCount, static_cast<std::size_t>(-1)), distribution.a(),
+		distribution.b(), hasAvx2() ? "true" : "false");
+	bool first(true);
+	std::size_t size(10);
+	for(int exponent(1); exponent <= maxExponent; ++exponent)
+	{
+		for(std::size_t variant(0); variant < variantCount; ++variant)
+		{
+			// Don't try larger sizes, if a variant failed already (e.g. ran out of memory).
+			if(allocatable[variant])
+			{
+				allocatable[variant] = benchmark(variants[variant].first,
+					variants[variant].second, size, distribution, threadCount, first);
+				first = false;
+			}
+		}
+		if(std::numeric_limits<std::size_t>::max() / 10 < size)
+		{
+			break;
+		}
+		size *= 10;
+	}
+	std::printf("\n  ]\n}\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// This header puts the _implicit_ constraints of the TemplateTyping examples into type traits,
+// which can be checked with static_assert and used to select the best implementation of a
+// generic function at compile time:
+// - IsSized<T>: T provides the embedded type size_type and the method size() const returning it
+//   (or a value convertible to it), size() may be inherited.
+// - IsRandomAccessRange<T>: the iterators of T (T::const_iterator) are random access iterators.
+// - IsContiguousRange<T>: the items of T are stored back to back in memory (std::vector (except
+//   std::vector<bool>), std::basic_string and std::array). This can't be detected from the
+//   outside, so further types have to specialize IsContiguousRange.
+// The traits are combined into a tag (RangeTag<T>::type), the tags derive from each other like
+// the iterator tags of the STL. A generic function like copyItems() passes the tag to its
+// overloads, and overload resolution takes the most specialized one: the call is resolved by the
+// compiler, there's no virtual dispatch at run time.
+
+
+// The sizes of the results of the detection functions below.
+typedef char DetectedType;
+struct NotDetectedType
+{
+    char padding[2];
+};
+
+
+// Checks, whether T provides the embedded type size_type.
+template <typename T> class HasSizeType
+{
+    template <typename U> static DetectedType detect(typename U::size_type*);
+    template <typename U> static NotDetectedType detect(...);
+
+public:
+    static const bool value = sizeof(DetectedType) == sizeof(detect<T>(0));
+};
+
+
+// Checks, whether T provides the embedded type size_type and the method size() const returning a
+// value convertible to size_type. The expression t.size() is checked for a const T t (not the
+// type of &T::size), so an inherited size() or one returning another integral type is accepted.
+// The expression is part of the signature of detect<U>(), so a T without a suitable size() (none,
+// a non-const one, one returning void, ...) fails the substitution and yields false.
+template <typename T, bool = HasSizeType<T>::value> class IsSized
+{
+public:
+    static const bool value = false;
+};
+
+template <typename T> class IsSized<T, true>
+{
+    // Only declared, they are only used in sizeof().
+    template <typename U> static const U& instance();
+    static DetectedType convert(typename T::size_type);
+
+    template <typename U>
+    static DetectedType detect(char (*)[sizeof(convert(instance<U>().size()))]);
+    template <typename U> static NotDetectedType detect(...);
+
+public:
+    static const bool value = sizeof(DetectedType) == sizeof(detect<T>(0));
+};
+
+
+// Checks, whether T provides the embedded type const_iterator.
+template <typename T> class HasConstIterator
+{
+    template <typename U> static DetectedType detect(typename U::const_iterator*);
+    template <typename U> static NotDetectedType detect(...);
+
+public:
+    static const bool value = sizeof(DetectedType) == sizeof(detect<T>(0));
+};
+
+
+// Checks, whether the iterators of T are random access iterators.
+template <typename T, bool = HasConstIterator<T>::value> struct IsRandomAccessRange
+    : std::false_type
+{
+};
+
+template <typename T> struct IsRandomAccessRange<T, true>
+    : std::is_base_of<std::random_access_iterator_tag,
+        typename std::iterator_traits<typename T::const_iterator>::iterator_category>
+{
+};
+
+
+// Checks, whether the items of T are stored contiguously. Specialize it for further types.
+template <typename T> struct IsContiguousRange
+    : std::false_type
+{
+};
+
+template <typename T, typename A> struct IsContiguousRange<std::vector<T, A> >
+    : std::true_type
+{
+};
+
+// std::vector<bool> packs its items into bits.
+template <typename A> struct IsContiguousRange<std::vector<bool, A> >
+    : std::false_type
+{
+};
+
+template <typename C, typename Tr, typename A>
+struct IsContiguousRange<std::basic_string<C, Tr, A> >
+    : std::true_type
+{
+};
+
+template <typename T, std::size_t N> struct IsContiguousRange<std::array<T, N> >
+    : std::true_type
+{
+};
+
+
+// The tags of the ranges, from the least to the most capable one.
+struct ForwardRangeTag
+{
+    static const char* name()
+    {
+        return "forward";
+    }
+};
+
+struct RandomAccessRangeTag : ForwardRangeTag
+{
+    static const char* name()
+    {
+        return "random access";
+    }
+};
+
+struct ContiguousRangeTag : RandomAccessRangeTag
+{
+    static const char* name()
+    {
+        return "contiguous";
+    }
+};
+
+
+// Yields the tag of the most capable concept T meets as type.
+template <typename T> struct RangeTag
+{
+    typedef typename std::conditional<IsContiguousRange<T>::value, ContiguousRangeTag,
+        typename std::conditional<IsRandomAccessRange<T>::value, RandomAccessRangeTag,
+            ForwardRangeTag>::type>::type type;
+};
+
+
+// Copies the items of any range by walking its iterators (e.g. the nodes of a std::set).
+template <typename T> void copyItems(const T& range, typename T::value_type* destination,
+    ForwardRangeTag)
+{
+    std::copy(range.begin(), range.end(), destination);
+}
+
+
+// Copies the items of a random access range by index.
+template <typename T> void copyItems(const T& range, typename T::value_type* destination,
+    RandomAccessRangeTag)
+{
+    const typename T::size_type size(range.size());
+    const typename T::const_iterator first(range.begin());
+    for (typename T::size_type index(0); index < size; ++index)
+    {
+        destination[index] = first[index];
+    }
+}
+
+
+// Copies the items of a contiguous range of PODs as one block of memory (memcpy() uses the
+// widest moves of the CPU).
+template <typename T> void copyContiguousItems(const T& range,
+    typename T::value_type* destination, std::true_type)
+{
+    if (!range.empty())
+    {
+        std::memcpy(destination, &*range.begin(), range.size() * sizeof(*destination));
+    }
+}
+
+
+// The items of a contiguous range, which aren't PODs, have to be assigned one by one.
+template <typename T> void copyContiguousItems(const T& range,
+    typename T::value_type* destination, std::false_type)
+{
+    copyItems(range, destination, RandomAccessRangeTag());
+}
+
+
+template <typename T> void copyItems(const T& range, typename T::value_type* destination,
+    ContiguousRangeTag)
+{
+    copyContiguousItems(range, destination, std::is_pod<typename T::value_type>());
+}
+
+
+// Copies the items of range to destination, which must provide room for range.size() items. The
+// fastest implementation for the concepts T meets is selected at compile time.
+template <typename T> void copyItems(const T& range, typename T::value_type* destination)
+{
+    static_assert(IsSized<T>::value,
+        "T must provide the embedded type size_type and the method size() const!");
+
+    copyItems(range, destination, typename RangeTag<T>::type());
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+
+// This header provides the output of the sizes reported by the TemplateTyping examples. With
+// std::printf("%d\n", size) the format string is parsed on each call, and "%d" expects an int,
+// so a 64-bit size_type is printed wrong (not just truncated: the arguments are read with the
+// wrong width). reportSize() instead selects the formatter by the type of the size at compile
+// time: SizeFormatter<SizeType> knows the width and the signedness of SizeType and writes the
+// digits itself. The text is collected in a buffer per thread, which is written to stdout only
+// when it's full, or when flushSizes() is called. As there are no destructors for thread-local
+// variables, the buffer of a thread must be flushed before the thread ends: a reporting function
+// (or thread procedure) owns a SizeFlusher, which flushes the buffer when it's left, and flush()
+// writes the sizes before other output to stdout, which must come after them. As a safety net for
+// the thread calling exit() (e.g. the main thread returning from main()), flushSizes() is
+// registered with std::atexit() when the first size is reported.
+
+
+#if defined(_MSC_VER)
+#define SIZE_FORMATTER_THREAD __declspec(thread)
+#else
+#define SIZE_FORMATTER_THREAD __thread
+#endif
+
+
+// The size of the buffer of each thread.
+const std::size_t SizeBufferSize(4096);
+
+
+// The buffer of the reported sizes of a thread. It's a POD, so that it can be thread-local.
+struct SizeBuffer
+{
+    char text[SizeBufferSize];
+    std::size_t used;
+};
+
+
+// Returns the buffer of the current thread.
+inline SizeBuffer& sizeBuffer()
+{
+    static SIZE_FORMATTER_THREAD SizeBuffer buffer;
+    return buffer;
+}
+
+
+// Writes the sizes reported by the current thread to stdout.
+inline void flushSizes()
+{
+    SizeBuffer& buffer(sizeBuffer());
+    if (0 != buffer.used)
+    {
+        std::fwrite(buffer.text, 1, buffer.used, stdout);
+        buffer.used = 0;
+    }
+}
+
+
+// Registers flushSizes() with std::atexit() once. The local static isn't guarded in VS2010, so two
+// threads reporting their first sizes at the same time may register it twice, which is harmless:
+// the second call finds the buffer empty.
+inline void flushSizesAtExit()
+{
+    static const bool registered(0 == std::atexit(&flushSizes));
+    (void)registered;
+}
+
+
+// Flushes the sizes reported by the current thread, when it goes out of scope.
+class SizeFlusher
+{
+public:
+    SizeFlusher()
+    {
+    }
+
+    ~SizeFlusher()
+    {
+        flushSizes();
+    }
+
+    // Writes the sizes reported so far, e.g. before other output to stdout.
+    void flush() const
+    {
+        flushSizes();
+    }
+
+private:
+    SizeFlusher(const SizeFlusher&);
+    SizeFlusher& operator=(const SizeFlusher&);
+};
+
+
+// Formats sizes of the integral type SizeType as decimal text followed by the end of a line.
+template <typename SizeType> struct SizeFormatter
+{
+    static_assert(std::is_integral<SizeType>::value, "size_type must be an integral type!");
+
+    // The most characters of a size: 3 digits per byte are enough (a byte holds less than 1000),
+    // plus the sign and the end of the line.
+    static const std::size_t MaxLength = 3 * sizeof(SizeType) + 2;
+
+    static void write(SizeType size)
+    {
+        SizeBuffer& buffer(sizeBuffer());
+        if (0 == buffer.used)
+        {
+            flushSizesAtExit();
+        }
+        if (SizeBufferSize - buffer.used < MaxLength)
+        {
+            flushSizes();
+        }
+
+        char digits[MaxLength];
+        char* const last(digits + MaxLength);
+        char* first(last);
+        *--first = '\n';
+        first = writeDigits(size, first, std::is_signed<SizeType>());
+        for (const char* character(first); character != last; ++character)
+        {
+            buffer.text[buffer.used++] = *character;
+        }
+    }
+
+private:
+    // Writes the digits of size backwards in front of last, returns the first character.
+    static char* writeDigits(SizeType size, char* last, std::false_type)
+    {
+        do
+        {
+            *--last = static_cast<char>('0' + size % 10);
+            size /= 10;
+        }
+        while (0 != size);
+        return last;
+    }
+
+    // Writes the digits (and the sign) of size backwards in front of last, returns the first
+    // character. The digits are negated one by one, so the smallest value doesn't overflow.
+    static char* writeDigits(SizeType size, char* last, std::true_type)
+    {
+        const bool negative(size < 0);
+        do
+        {
+            const int digit(static_cast<int>(size % 10));
+            *--last = static_cast<char>('0' + (negative ? -digit : digit));
+            size /= 10;
+        }
+        while (0 != size);
+        if (negative)
+        {
+            *--last = '-';
+        }
+        return last;
+    }
+};
+
+
+// Reports size (on a line of its own) with the formatter of its type.
+template <typename SizeType> void reportSize(SizeType size)
+{
+    SizeFormatter<SizeType>::write(size);
+}
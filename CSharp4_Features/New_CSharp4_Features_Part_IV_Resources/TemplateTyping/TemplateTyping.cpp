@@ -3,9 +3,17 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <type_traits>
+#include <utility>
+
+#include "RangeConcepts.h"
+#include "SizeFormatter.h"
 
 // These examples show:
 // - Template Typing and Consistency.
+// - Expressing the constraints on T with type traits, and selecting the best implementation of a
+//   generic function for T at compile time (see "RangeConcepts.h").
+// - Formatting a value by its type selected at compile time (see "SizeFormatter.h").
 
 // In C++ we don't (and for the time being we can't) specify a special interface that T must obey
 // to. Instead we just directly call the method size() on t, which is of type T. As you see we do
@@ -13,14 +21,115 @@
 // 1. T has to provide a method of name size(), returning a value (please read on).
 // 2. T has to provide an embedded type with the name size_type.
 // 3. Instances of size_type must be able to be created from the result of the method size().
-// In the end the code is checked at compile time.
+// In the end the code is checked at compile time. The static_assert states requirements 1. to 3.
+// explicitly (see IsSized in "RangeConcepts.h"), so a type not meeting them gets a clear message.
 template <typename T> void TemplateTyping(const T& t)
 {
+    static_assert(IsSized<T>::value,
+        "T must provide the embedded type size_type and the method size() const!");
+
     const typename T::size_type size(t.size());
-    std::printf("%d\n", size);
+    reportSize(size);
 }
 
 
+// The checks of IsSized, a failed check stops the compilation. size() and size_type can be
+// inherited (as std::set inherits them from its tree in the VS2010 STL), and size() may return
+// another integral type, which is convertible to size_type.
+struct SizedBase
+{
+    typedef std::size_t size_type;
+
+    size_type size() const
+    {
+        return 0;
+    }
+};
+
+struct InheritedSize : SizedBase
+{
+};
+
+struct IntSize
+{
+    typedef std::size_t size_type;
+
+    int size() const
+    {
+        return 0;
+    }
+};
+
+struct OnlySizeType
+{
+    typedef std::size_t size_type;
+};
+
+struct NonConstSize
+{
+    typedef std::size_t size_type;
+
+    size_type size()
+    {
+        return 0;
+    }
+};
+
+// VS2010 doesn't know final yet.
+#if !defined(_MSC_VER) || 1700 <= _MSC_VER
+struct FinalSize final : SizedBase
+{
+};
+
+static_assert(IsSized<FinalSize>::value, "A size() of a final class must be detected!");
+#endif
+
+static_assert(IsSized<InheritedSize>::value, "An inherited size() must be detected!");
+static_assert(IsSized<IntSize>::value, "A size() convertible to size_type must be detected!");
+static_assert(IsSized<std::set<int> >::value, "std::set<int> must be detected!");
+static_assert(!IsSized<OnlySizeType>::value, "A type without size() must not be detected!");
+static_assert(!IsSized<NonConstSize>::value, "A non-const size() must not be detected!");
+static_assert(!IsSized<int>::value, "int must not be detected!");
+
+
+// Yields the type of the parameter of the call operator of the functor F (or of the function F),
+// which is called with one argument, as type. For functors (e.g. lambdas) the type is taken from
+// the pointer to the call operator, so F must have exactly one call operator.
+template <typename F> struct ProviderParameter
+    : ProviderParameter<decltype(&F::operator())>
+{
+};
+
+template <typename R, typename C, typename A> struct ProviderParameter<R (C::*)(A)>
+{
+    typedef A type;
+};
+
+template <typename R, typename C, typename A> struct ProviderParameter<R (C::*)(A) const>
+{
+    typedef A type;
+};
+
+template <typename R, typename A> struct ProviderParameter<R (*)(A)>
+{
+    typedef A type;
+};
+
+template <typename R, typename A> struct ProviderParameter<R (A)>
+{
+    typedef A type;
+};
+
+
+// Checks, whether the functor (or function) F takes its argument by value. Then each call copies
+// the argument, for a container this is a deep copy of all of its items.
+template <typename F> struct TakesArgumentByValue
+    : std::integral_constant<bool, !std::is_reference<
+        typename ProviderParameter<typename std::remove_reference<F>::type>::type>::value>
+{
+};
+
+
 // Here we still don't express direct constraints on T or F, but we could reduce the _implicit_
 // constraints on T:
 // 1. T has to provide an embedded type with the name size_type.
@@ -32,10 +141,18 @@ template <typename T> void TemplateTyping(const T& t)
 // freedom in C++ that we have in C# with delegates to enable high-order function calling and good
 // and easy reusability. In C++0x lengthProvider can be passed as lambda, please see below.
 // In the end the code is also checked at compile time.
-template <typename T, typename F> void TemplateTypingWLambda(const T& t, F lengthProvider)
+// A lengthProvider accepting T by value would copy the whole container (with all its items) just
+// to get its size, the static_assert rejects such providers with a clear message. The provider
+// itself is passed by (forwarding) reference, so a functor isn't copied either, i.e. getting the
+// size of even a huge container costs as much as calling its size().
+template <typename T, typename F> void TemplateTypingWLambda(const T& t, F&& lengthProvider)
 {
-    const typename T::size_type size(lengthProvider(t));
-    std::printf("%d\n", size);
+    static_assert(!TakesArgumentByValue<F>::value,
+        "lengthProvider must accept the container by reference (e.g. const T&), otherwise each "
+        "call copies the whole container!");
+
+    const typename T::size_type size(std::forward<F>(lengthProvider)(t));
+    reportSize(size);
 }
 
 
@@ -77,6 +194,10 @@ template <typename T, typename F> void TemplateTypingWLambda(const T& t, F lengt
 
 int _tmain(int argc, _TCHAR* argv[])
 {    
+    // The sizes are collected in a buffer of this thread, the flusher writes them out, at the
+    // latest when main() is left.
+    const SizeFlusher sizesFlusher;
+
     /*-------------------------------------------------------------------------------------------*/
     // Consistency with Template Typing:
 
@@ -106,8 +227,35 @@ int _tmain(int argc, _TCHAR* argv[])
     // Consistency with the lightweight variant with lambdas as functors. Then the constraint of the
     // template type argument to have a size() method is encapsulated away (into the lambda), and
     // only visible on the caller's side (just neat how easy it is to express consistency here):
-    TemplateTypingWLambda(strings, [](std::vector<std::string> v){ return v.size(); });
-    TemplateTypingWLambda(numbers, [](std::set<int> s){ return s.size(); });
+    // The lambdas accept the containers by const reference, a lambda accepting a container by
+    // value (e.g. [](std::vector<std::string> v){ return v.size(); }) would copy it for each call,
+    // and is rejected by TemplateTypingWLambda().
+    TemplateTypingWLambda(strings, [](const std::vector<std::string>& v){ return v.size(); });
+    TemplateTypingWLambda(numbers, [](const std::set<int>& s){ return s.size(); });
+
+
+    // Write the sizes before any other output.
+    sizesFlusher.flush();
+
+    /*-------------------------------------------------------------------------------------------*/
+    // Selecting the implementation with Template Typing:
+
+    // The traits of "RangeConcepts.h" check, which concepts a type meets. copyItems() then takes
+    // the best implementation for the type at compile time: the items of a std::vector<int> are
+    // copied with one memcpy(), the items of a std::vector<std::string> are assigned by index and
+    // the nodes of a std::set<int> are walked by the iterators. The call is always the same.
+    std::vector<int> vectorNumbers(numbers.begin(), numbers.end());
+    std::vector<int> copiedNumbers(numbers.size());
+    copyItems(vectorNumbers, &copiedNumbers[0]);
+    std::printf("%s: %d %d\n", RangeTag<std::vector<int> >::type::name(), copiedNumbers[0],
+        copiedNumbers[1]);
+    copyItems(numbers, &copiedNumbers[0]);
+    std::printf("%s: %d %d\n", RangeTag<std::set<int> >::type::name(), copiedNumbers[0],
+        copiedNumbers[1]);
+    std::vector<std::string> copiedStrings(strings.size());
+    copyItems(strings, &copiedStrings[0]);
+    std::printf("%s: %s %s\n", RangeTag<std::vector<std::string> >::type::name(),
+        copiedStrings[0].c_str(), copiedStrings[1].c_str());
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
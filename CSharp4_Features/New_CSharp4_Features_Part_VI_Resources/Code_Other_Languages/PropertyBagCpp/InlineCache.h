@@ -0,0 +1,140 @@
+// InlineCache.h : A polymorphic inline cache for dynamic accesses by name.
+
+#pragma once
+
+#include <cstddef>
+
+// A dynamic access by name (a message to an Objective-C object, IDispatch::GetIDsOfNames()) has
+// to resolve the name to a slot (a method, a DISPID, an index) on each call, because the receiver
+// may be of another type on each call. Most call sites see only one type of receivers though, or
+// a few. An InlineCache belongs to one call site (one name) and remembers the slots the name was
+// resolved to for the last receivers. It starts monomorphic (one receiver), becomes polymorphic
+// (up to Entries receivers) and ends megamorphic: if there are more receivers, the entries are
+// replaced one after the other. A hit costs some comparisons, no string is handled at all.
+// The receiver must identify the resolution: e.g. the address of an object and something making
+// it unique (a reference to the object, or a counter of its layout), otherwise another object
+// created at the address of a destroyed one would hit the entry of the destroyed one. Failed
+// resolutions aren't cached. An InlineCache isn't synchronized: give each thread its own one.
+// It only uses C++03, so that it works with the VS2010 projects, too.
+
+
+// The count of receivers an InlineCache remembers by default.
+const std::size_t DefaultInlineCacheEntries(4);
+
+
+// Caches the slots of a name for up to Entries receivers.
+template <typename ReceiverType, typename SlotType,
+	std::size_t Entries = DefaultInlineCacheEntries>
+class InlineCache
+{
+public:
+	enum State
+	{
+		Uninitialized,
+		Monomorphic,
+		Polymorphic,
+		Megamorphic
+	};
+
+	InlineCache()
+		: count_(0), next_(0), misses_(0)
+	{
+	}
+
+	// Gets the slot of receiver into slot. On a miss resolve(receiver, slot) is called, which
+	// must return false, if receiver has no such slot. Returns whether there's a slot.
+	template <typename ResolverType>
+	bool lookup(const ReceiverType& receiver, SlotType& slot, ResolverType resolve)
+	{
+		for (std::size_t entry(0); entry < count_; ++entry)
+		{
+			if (entries_[entry].receiver == receiver)
+			{
+				slot = entries_[entry].slot;
+				return true;
+			}
+		}
+
+		++misses_;
+		if (!resolve(receiver, slot))
+		{
+			return false;
+		}
+		remember(receiver, slot);
+		return true;
+	}
+
+	// Forgets the slot of receiver (e.g. before the receiver is destroyed).
+	void forget(const ReceiverType& receiver)
+	{
+		for (std::size_t entry(0); entry < count_; ++entry)
+		{
+			if (entries_[entry].receiver == receiver)
+			{
+				entries_[entry] = entries_[--count_];
+				entries_[count_] = Entry();
+				next_ = count_;
+				return;
+			}
+		}
+	}
+
+	void clear()
+	{
+		for (std::size_t entry(0); entry < count_; ++entry)
+		{
+			entries_[entry] = Entry();
+		}
+		count_ = 0;
+		next_ = 0;
+		misses_ = 0;
+	}
+
+	State state() const
+	{
+		if (Entries < misses_)
+		{
+			return Megamorphic;
+		}
+		return 0 == count_ ? Uninitialized : 1 == count_ ? Monomorphic : Polymorphic;
+	}
+
+	// The count of lookups, which had to resolve the name (hits aren't counted, they should be
+	// as cheap as possible).
+	std::size_t misses() const
+	{
+		return misses_;
+	}
+
+private:
+	struct Entry
+	{
+		Entry()
+			: receiver(), slot()
+		{
+		}
+
+		ReceiverType receiver;
+		SlotType slot;
+	};
+
+	void remember(const ReceiverType& receiver, const SlotType& slot)
+	{
+		if (count_ < Entries)
+		{
+			entries_[count_].receiver = receiver;
+			entries_[count_].slot = slot;
+			next_ = ++count_ % Entries;
+			return;
+		}
+		// Megamorphic: replaces the oldest entry.
+		entries_[next_].receiver = receiver;
+		entries_[next_].slot = slot;
+		next_ = (next_ + 1) % Entries;
+	}
+
+	Entry entries_[Entries];
+	std::size_t count_;
+	std::size_t next_;
+	std::size_t misses_;
+};
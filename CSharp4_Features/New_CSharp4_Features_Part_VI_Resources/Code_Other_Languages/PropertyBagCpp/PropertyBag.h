@@ -0,0 +1,754 @@
+// PropertyBag.h : A property bag with interned keys.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "InlineCache.h"
+
+// This is the PropertyBag of the Objective-C example in C++. Objective-C forwards each unknown
+// message to forwardInvocation:, which splits the name of the selector to find the name of the
+// property, and looks the name up in an NSMutableDictionary: each access parses and hashes a
+// string. C++ has no message forwarding, the properties are accessed with keys instead:
+// - PropertyKey::intern() maps the name of a property to a small integer once (keep the key, e.g.
+//   in a static constant), an access by key doesn't touch the name.
+// - PropertyValue holds a value of any copyable type. Small values (up to the size of a
+//   std::string) are stored within the PropertyValue, larger ones on the heap.
+// - PropertyBag maps the keys to the values in a flat hash map with open addressing: the slots
+//   are stored in one array, which is probed linearly from the slot the key hashes to.
+// So an access by key costs a multiplication and (mostly) one comparison, and setting a property
+// to a value of the type it already has assigns the value in place without allocating (unless
+// the type itself allocates, like a long std::string). A PropertyCallSite is the counterpart of
+// forwardInvocation: for code, which only knows the name of a property: it interns the name
+// once and caches the slots of the property in the bags it accesses (see InlineCache.h). Compile
+// with C++11 (the keys are interned thread-safe, the bags aren't synchronized).
+
+
+// The key of a property: the interned name.
+class PropertyKey
+{
+	friend class PropertyBag;
+
+public:
+	// Returns the key of name, the same one for the same name.
+	static PropertyKey intern(const std::string& name)
+	{
+		Names& names(allNames());
+		std::lock_guard<std::mutex> lock(names.mutex);
+		const auto known(names.ids.find(name));
+		if (known != names.ids.end())
+		{
+			return PropertyKey(known->second);
+		}
+		const std::size_t id(names.names.size());
+		names.names.push_back(name);
+		names.ids.insert(std::make_pair(name, id));
+		return PropertyKey(id);
+	}
+
+	const std::string& name() const
+	{
+		Names& names(allNames());
+		std::lock_guard<std::mutex> lock(names.mutex);
+		return names.names[id_];
+	}
+
+	std::size_t id() const
+	{
+		return id_;
+	}
+
+	bool operator==(const PropertyKey& other) const
+	{
+		return id_ == other.id_;
+	}
+
+	bool operator!=(const PropertyKey& other) const
+	{
+		return id_ != other.id_;
+	}
+
+private:
+	explicit PropertyKey(std::size_t id)
+		: id_(id)
+	{
+	}
+
+	// The interned names. The names are kept in a deque, so that the references returned by
+	// name() stay valid.
+	struct Names
+	{
+		std::mutex mutex;
+		std::unordered_map<std::string, std::size_t> ids;
+		std::deque<std::string> names;
+	};
+
+	static Names& allNames()
+	{
+		static Names names;
+		return names;
+	}
+
+	std::size_t id_;
+};
+
+
+// Yields the type, in which a PropertyValue stores a value of type T: string literals are stored
+// as std::string.
+template<typename T>
+struct PropertyValueType
+{
+	typedef typename std::decay<T>::type DecayedType;
+	typedef typename std::conditional<std::is_same<DecayedType, const char*>::value
+		|| std::is_same<DecayedType, char*>::value, std::string, DecayedType>::type type;
+};
+
+
+// A value of any copyable type, or no value.
+class PropertyValue
+{
+	typedef std::aligned_storage<32>::type Storage;
+
+	// The operations on the stored value of a type, the address identifies the type.
+	struct Operations
+	{
+		void (*copy)(const Storage& source, Storage& destination);
+		// Moves the value and destroys the source.
+		void (*move)(Storage& source, Storage& destination);
+		void (*destroy)(Storage& storage);
+	};
+
+	// Values, which fit into the storage and can be moved without throwing, are stored in place.
+	template<typename T>
+	struct IsStoredInPlace
+		: std::integral_constant<bool, sizeof(T) <= sizeof(Storage)
+			&& 0 == std::alignment_of<Storage>::value % std::alignment_of<T>::value
+			&& std::is_nothrow_move_constructible<T>::value>
+	{
+	};
+
+	template<typename T, bool = IsStoredInPlace<T>::value>
+	struct Handler
+	{
+		static T* get(Storage& storage)
+		{
+			return reinterpret_cast<T*>(&storage);
+		}
+
+		static const T* get(const Storage& storage)
+		{
+			return reinterpret_cast<const T*>(&storage);
+		}
+
+		template<typename... Arguments>
+		static void create(Storage& storage, Arguments&&... arguments)
+		{
+			::new(static_cast<void*>(&storage)) T(std::forward<Arguments>(arguments)...);
+		}
+
+		static void copy(const Storage& source, Storage& destination)
+		{
+			create(destination, *get(source));
+		}
+
+		static void move(Storage& source, Storage& destination)
+		{
+			create(destination, std::move(*get(source)));
+			destroy(source);
+		}
+
+		static void destroy(Storage& storage)
+		{
+			get(storage)->~T();
+		}
+
+		static const Operations operations;
+	};
+
+	// Stores a pointer to the value on the heap.
+	template<typename T>
+	struct Handler<T, false>
+	{
+		static T* get(Storage& storage)
+		{
+			return *reinterpret_cast<T**>(&storage);
+		}
+
+		static const T* get(const Storage& storage)
+		{
+			return *reinterpret_cast<T* const*>(&storage);
+		}
+
+		template<typename... Arguments>
+		static void create(Storage& storage, Arguments&&... arguments)
+		{
+			T* const value(new T(std::forward<Arguments>(arguments)...));
+			::new(static_cast<void*>(&storage)) T*(value);
+		}
+
+		static void copy(const Storage& source, Storage& destination)
+		{
+			create(destination, *get(source));
+		}
+
+		static void move(Storage& source, Storage& destination)
+		{
+			::new(static_cast<void*>(&destination)) T*(get(source));
+		}
+
+		static void destroy(Storage& storage)
+		{
+			delete get(storage);
+		}
+
+		static const Operations operations;
+	};
+
+	// Excludes PropertyValue from the constructor and the assignment of values.
+	template<typename T>
+	struct IsValue
+		: std::integral_constant<bool,
+			!std::is_same<typename std::decay<T>::type, PropertyValue>::value>
+	{
+	};
+
+public:
+	PropertyValue()
+		: operations_(nullptr)
+	{
+	}
+
+	template<typename T, typename = typename std::enable_if<IsValue<T>::value>::type>
+	PropertyValue(T&& value)
+		: operations_(nullptr)
+	{
+		emplace<typename PropertyValueType<T>::type>(std::forward<T>(value));
+	}
+
+	PropertyValue(const PropertyValue& other)
+		: operations_(nullptr)
+	{
+		if (other.operations_)
+		{
+			other.operations_->copy(other.storage_, storage_);
+			operations_ = other.operations_;
+		}
+	}
+
+	PropertyValue(PropertyValue&& other) noexcept
+		: operations_(nullptr)
+	{
+		take(other);
+	}
+
+	~PropertyValue()
+	{
+		reset();
+	}
+
+	PropertyValue& operator=(const PropertyValue& other)
+	{
+		if (this != &other)
+		{
+			PropertyValue copy(other);
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	PropertyValue& operator=(PropertyValue&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			take(other);
+		}
+		return *this;
+	}
+
+	// Assigns value in place, if this holds a value of the same type already.
+	template<typename T>
+	typename std::enable_if<IsValue<T>::value, PropertyValue&>::type operator=(T&& value)
+	{
+		typedef typename PropertyValueType<T>::type ValueType;
+		if (ValueType* const current = get<ValueType>())
+		{
+			*current = std::forward<T>(value);
+		}
+		else
+		{
+			emplace<ValueType>(std::forward<T>(value));
+		}
+		return *this;
+	}
+
+	// Replaces the value by a T constructed from arguments.
+	template<typename T, typename... Arguments>
+	T& emplace(Arguments&&... arguments)
+	{
+		reset();
+		Handler<T>::create(storage_, std::forward<Arguments>(arguments)...);
+		operations_ = &Handler<T>::operations;
+		return *Handler<T>::get(storage_);
+	}
+
+	bool empty() const
+	{
+		return !operations_;
+	}
+
+	template<typename T>
+	bool is() const
+	{
+		return &Handler<T>::operations == operations_;
+	}
+
+	// Returns the value, if it's a T, otherwise nullptr.
+	template<typename T>
+	T* get()
+	{
+		return is<T>() ? Handler<T>::get(storage_) : nullptr;
+	}
+
+	template<typename T>
+	const T* get() const
+	{
+		return is<T>() ? Handler<T>::get(storage_) : nullptr;
+	}
+
+	void reset()
+	{
+		if (operations_)
+		{
+			operations_->destroy(storage_);
+			operations_ = nullptr;
+		}
+	}
+
+private:
+	// Moves the value of other (this has no value).
+	void take(PropertyValue& other)
+	{
+		if (other.operations_)
+		{
+			other.operations_->move(other.storage_, storage_);
+			operations_ = other.operations_;
+			other.operations_ = nullptr;
+		}
+	}
+
+	Storage storage_;
+	const Operations* operations_;
+};
+
+template<typename T, bool InPlace>
+const PropertyValue::Operations PropertyValue::Handler<T, InPlace>::operations =
+{
+	&PropertyValue::Handler<T, InPlace>::copy,
+	&PropertyValue::Handler<T, InPlace>::move,
+	&PropertyValue::Handler<T, InPlace>::destroy
+};
+
+template<typename T>
+const PropertyValue::Operations PropertyValue::Handler<T, false>::operations =
+{
+	&PropertyValue::Handler<T, false>::copy,
+	&PropertyValue::Handler<T, false>::move,
+	&PropertyValue::Handler<T, false>::destroy
+};
+
+
+// Maps keys to values.
+class PropertyBag
+{
+public:
+	// Identifies the positions of the properties in the slots of a bag: it changes, when a
+	// property is moved to another slot (by rehash() or erase()), or the bag is assigned.
+	struct Layout
+	{
+		Layout()
+			: bag(nullptr), id(0)
+		{
+		}
+
+		bool operator==(const Layout& other) const
+		{
+			return bag == other.bag && id == other.id;
+		}
+
+		const PropertyBag* bag;
+		std::uint64_t id;
+	};
+
+	PropertyBag()
+		: size_(0), shift_(64), layout_(newLayout())
+	{
+	}
+
+	PropertyBag(const PropertyBag& other)
+		: slots_(other.slots_), size_(other.size_), shift_(other.shift_), layout_(newLayout())
+	{
+	}
+
+	PropertyBag(PropertyBag&& other)
+		: slots_(std::move(other.slots_)), size_(other.size_), shift_(other.shift_),
+		layout_(newLayout())
+	{
+		other.clear();
+	}
+
+	PropertyBag& operator=(const PropertyBag& other)
+	{
+		if (this != &other)
+		{
+			slots_ = other.slots_;
+			size_ = other.size_;
+			shift_ = other.shift_;
+			layout_ = newLayout();
+		}
+		return *this;
+	}
+
+	PropertyBag& operator=(PropertyBag&& other)
+	{
+		if (this != &other)
+		{
+			slots_ = std::move(other.slots_);
+			size_ = other.size_;
+			shift_ = other.shift_;
+			layout_ = newLayout();
+			other.clear();
+		}
+		return *this;
+	}
+
+	void clear()
+	{
+		slots_.clear();
+		size_ = 0;
+		shift_ = 64;
+		layout_ = newLayout();
+	}
+
+	Layout layout() const
+	{
+		Layout layout;
+		layout.bag = this;
+		layout.id = layout_;
+		return layout;
+	}
+
+	// Gets the slot of the property key, returns false, if it's missing. The slot is valid as
+	// long as the layout() doesn't change.
+	bool findSlot(PropertyKey key, std::size_t& slot) const
+	{
+		slot = findSlot(key.id_);
+		return NotFound != slot;
+	}
+
+	const PropertyValue& valueAt(std::size_t slot) const
+	{
+		return slots_[slot].value;
+	}
+
+	PropertyValue& valueAt(std::size_t slot)
+	{
+		return slots_[slot].value;
+	}
+
+	std::size_t size() const
+	{
+		return size_;
+	}
+
+	bool empty() const
+	{
+		return 0 == size_;
+	}
+
+	// Makes room for count properties, so that adding them doesn't rehash.
+	void reserve(std::size_t count)
+	{
+		std::size_t capacity(MinCapacity);
+		while (capacity * MaxLoadNumerator < count * MaxLoadDenominator)
+		{
+			capacity *= 2;
+		}
+		if (slots_.size() < capacity)
+		{
+			rehash(capacity);
+		}
+	}
+
+	// Returns the value of the property key, or nullptr.
+	const PropertyValue* find(PropertyKey key) const
+	{
+		const std::size_t slot(findSlot(key.id_));
+		return NotFound != slot ? &slots_[slot].value : nullptr;
+	}
+
+	PropertyValue* find(PropertyKey key)
+	{
+		const std::size_t slot(findSlot(key.id_));
+		return NotFound != slot ? &slots_[slot].value : nullptr;
+	}
+
+	// Returns the value of the property key, if it's a T, otherwise nullptr.
+	template<typename T>
+	const T* get(PropertyKey key) const
+	{
+		const PropertyValue* const value(find(key));
+		return value ? value->get<T>() : nullptr;
+	}
+
+	// Returns the value of the property key, adds the property with no value, if it's missing.
+	PropertyValue& operator[](PropertyKey key)
+	{
+		const std::size_t slot(findSlot(key.id_));
+		return NotFound != slot ? slots_[slot].value : insert(key.id_);
+	}
+
+	// Sets the property key to value.
+	template<typename T>
+	void set(PropertyKey key, T&& value)
+	{
+		(*this)[key] = std::forward<T>(value);
+	}
+
+	// Removes the property key, returns false, if it's missing.
+	bool erase(PropertyKey key)
+	{
+		std::size_t hole(findSlot(key.id_));
+		if (NotFound == hole)
+		{
+			return false;
+		}
+
+		// Shifts the following slots of the probe sequence back into the hole, so that no slot
+		// has to be marked as deleted.
+		const std::size_t mask(slots_.size() - 1);
+		for (std::size_t slot((hole + 1) & mask); EmptyId != slots_[slot].id;
+			slot = (slot + 1) & mask)
+		{
+			const std::size_t home(homeSlot(slots_[slot].id));
+			// Shift the slot, unless its home is cyclically in (hole, slot].
+			const bool stays(hole < slot
+				? hole < home && home <= slot
+				: hole < home || home <= slot);
+			if (!stays)
+			{
+				slots_[hole].id = slots_[slot].id;
+				slots_[hole].value = std::move(slots_[slot].value);
+				hole = slot;
+			}
+		}
+		slots_[hole].id = EmptyId;
+		slots_[hole].value.reset();
+		--size_;
+		layout_ = newLayout();
+		return true;
+	}
+
+	// Calls visitor(key, value) for each property (in no particular order).
+	template<typename Visitor>
+	void forEach(Visitor visitor) const
+	{
+		for (auto slot(slots_.begin()); slot != slots_.end(); ++slot)
+		{
+			if (EmptyId != slot->id)
+			{
+				visitor(PropertyKey(slot->id), slot->value);
+			}
+		}
+	}
+
+private:
+	struct Slot
+	{
+		Slot()
+			: id(EmptyId)
+		{
+		}
+
+		std::size_t id;
+		PropertyValue value;
+	};
+
+	static const std::size_t EmptyId = static_cast<std::size_t>(-1);
+	static const std::size_t NotFound = static_cast<std::size_t>(-1);
+	static const std::size_t MinCapacity = 8;
+	// The slots are at most 3/4 used.
+	static const std::size_t MaxLoadNumerator = 3;
+	static const std::size_t MaxLoadDenominator = 4;
+
+	// Returns a layout id, which no bag had before.
+	static std::uint64_t newLayout()
+	{
+		static std::atomic<std::uint64_t> lastLayout(0);
+		return ++lastLayout;
+	}
+
+	// Fibonacci hashing: the upper bits of the product are the slot. The keys are dense, they
+	// spread evenly over the slots.
+	std::size_t homeSlot(std::size_t id) const
+	{
+		return static_cast<std::size_t>(
+			(static_cast<std::uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> shift_);
+	}
+
+	std::size_t findSlot(std::size_t id) const
+	{
+		if (slots_.empty())
+		{
+			return NotFound;
+		}
+		const std::size_t mask(slots_.size() - 1);
+		for (std::size_t slot(homeSlot(id)); ; slot = (slot + 1) & mask)
+		{
+			if (id == slots_[slot].id)
+			{
+				return slot;
+			}
+			if (EmptyId == slots_[slot].id)
+			{
+				return NotFound;
+			}
+		}
+	}
+
+	// Adds the missing id.
+	PropertyValue& insert(std::size_t id)
+	{
+		if (slots_.size() * MaxLoadNumerator < (size_ + 1) * MaxLoadDenominator)
+		{
+			rehash(slots_.empty() ? MinCapacity : 2 * slots_.size());
+		}
+		const std::size_t mask(slots_.size() - 1);
+		std::size_t slot(homeSlot(id));
+		while (EmptyId != slots_[slot].id)
+		{
+			slot = (slot + 1) & mask;
+		}
+		slots_[slot].id = id;
+		++size_;
+		return slots_[slot].value;
+	}
+
+	// Moves the properties into capacity (a power of 2) slots.
+	void rehash(std::size_t capacity)
+	{
+		std::vector<Slot> slots(capacity);
+		slots.swap(slots_);
+		layout_ = newLayout();
+		shift_ = 64;
+		for (std::size_t bits(capacity); 1 < bits; bits /= 2)
+		{
+			--shift_;
+		}
+		size_ = 0;
+		for (auto slot(slots.begin()); slot != slots.end(); ++slot)
+		{
+			if (EmptyId != slot->id)
+			{
+				insert(slot->id) = std::move(slot->value);
+			}
+		}
+	}
+
+	std::vector<Slot> slots_;
+	std::size_t size_;
+	// 64 - log2 of the count of slots.
+	unsigned shift_;
+	std::uint64_t layout_;
+};
+
+
+// Accesses the property name of any PropertyBag: the name is interned once, when the call site
+// is created (e.g. as static local variable), and the slots of the property are cached per bag.
+class PropertyCallSite
+{
+	// Resolves the key in a bag, on a miss of the cache.
+	struct SlotResolver
+	{
+		explicit SlotResolver(PropertyKey key)
+			: key(key)
+		{
+		}
+
+		bool operator()(const PropertyBag::Layout& layout, std::size_t& slot) const
+		{
+			return layout.bag->findSlot(key, slot);
+		}
+
+		PropertyKey key;
+	};
+
+public:
+	explicit PropertyCallSite(const std::string& name)
+		: key_(PropertyKey::intern(name))
+	{
+	}
+
+	PropertyKey key() const
+	{
+		return key_;
+	}
+
+	// Returns the value of the property in bag, or nullptr.
+	const PropertyValue* find(const PropertyBag& bag)
+	{
+		std::size_t slot(0);
+		return cache_.lookup(bag.layout(), slot, SlotResolver(key_))
+			? &bag.valueAt(slot)
+			: nullptr;
+	}
+
+	PropertyValue* find(PropertyBag& bag)
+	{
+		std::size_t slot(0);
+		return cache_.lookup(bag.layout(), slot, SlotResolver(key_))
+			? &bag.valueAt(slot)
+			: nullptr;
+	}
+
+	// Returns the value of the property in bag, if it's a T, otherwise nullptr.
+	template<typename T>
+	const T* get(const PropertyBag& bag)
+	{
+		const PropertyValue* const value(find(bag));
+		return value ? value->get<T>() : nullptr;
+	}
+
+	// Sets the property in bag to value. Adding a property doesn't move the other properties.
+	template<typename T>
+	void set(PropertyBag& bag, T&& value)
+	{
+		if (PropertyValue* const current = find(bag))
+		{
+			*current = std::forward<T>(value);
+		}
+		else
+		{
+			bag.set(key_, std::forward<T>(value));
+		}
+	}
+
+	const InlineCache<PropertyBag::Layout, std::size_t>& cache() const
+	{
+		return cache_;
+	}
+
+private:
+	PropertyKey key_;
+	InlineCache<PropertyBag::Layout, std::size_t> cache_;
+};
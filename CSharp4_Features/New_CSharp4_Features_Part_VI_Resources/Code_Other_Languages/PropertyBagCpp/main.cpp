@@ -0,0 +1,60 @@
+// main.cpp : The PropertyBag example in C++.
+
+#include <iostream>
+#include <string>
+
+#include "PropertyBag.h"
+
+// The keys are interned once, the accesses below don't handle the names anymore.
+static const PropertyKey numberProperty(PropertyKey::intern("numberProperty"));
+static const PropertyKey textProperty(PropertyKey::intern("textProperty"));
+
+
+int main()
+{
+	//----------------------------------------------------------------------------------------------
+	// The PropertyBag Type with interned Keys:
+
+	PropertyBag propertyBag;
+
+	// Set a number as new property and then get this number and write it to the console:
+	propertyBag.set(numberProperty, 42);
+	std::cout << "Here the stored number: " << *propertyBag.get<int>(numberProperty) << std::endl;
+
+	// As you can see the type of the formerly added property "numberProperty" is not fixed to int.
+	// It could be set to a std::string ("text" in this case):
+	propertyBag.set(numberProperty, "text");
+	std::cout << "Here the stored text: " << *propertyBag.get<std::string>(numberProperty)
+		<< std::endl;
+
+	// But then it's no int anymore, get() checks the type:
+	std::cout << "Is it still a number? " << (propertyBag.get<int>(numberProperty) ? "yes" : "no")
+		<< std::endl;
+
+	// But in such a case we are better off introducing a new property like so:
+	propertyBag.set(textProperty, "another text");
+	std::cout << "Here the stored text: " << *propertyBag.get<std::string>(textProperty)
+		<< std::endl;
+
+	// A property not set has no value:
+	const PropertyKey missingProperty(PropertyKey::intern("missingProperty"));
+	std::cout << "Is " << missingProperty.name() << " set? "
+		<< (propertyBag.find(missingProperty) ? "yes" : "no") << std::endl;
+
+	//----------------------------------------------------------------------------------------------
+	// Access by Name through a Call Site:
+
+	// Code, which only knows the name of the property (like forwardInvocation: in Objective-C),
+	// uses a call site: the name is interned once, and the slot of the property in the bag is
+	// cached, so the loop neither parses nor hashes the name.
+	static PropertyCallSite numberSite("numberProperty");
+	for (int number(0); number < 3; ++number)
+	{
+		numberSite.set(propertyBag, number);
+		std::cout << "Here the stored number: " << *numberSite.get<int>(propertyBag) << std::endl;
+	}
+	std::cout << "The name was resolved " << numberSite.cache().misses() << " time(s)."
+		<< std::endl;
+
+	return 0;
+}
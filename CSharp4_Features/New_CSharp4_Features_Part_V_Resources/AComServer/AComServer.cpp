@@ -6,6 +6,7 @@
 #include "AComServer_i.h"
 #include "dllmain.h"
 #include "xdlldata.h"
+#include "NicosComClass.h"
 
 
 // Used to determine whether the DLL can be unloaded by OLE.
@@ -16,7 +17,15 @@ STDAPI DllCanUnloadNow(void)
 	if (hr != S_OK)
 		return hr;
 #endif
-			return _AtlModule.DllCanUnloadNow();
+	const HRESULT moduleHr(_AtlModule.DllCanUnloadNow());
+#ifdef ACOMSERVER_POOLED_OBJECTS
+	// The DLL may be unloaded now: destroy the pooled objects here, outside of the loader lock.
+	if (S_OK == moduleHr)
+	{
+		CComPooledObject<CNicosComClass>::DrainPool();
+	}
+#endif
+	return moduleHr;
 	}
 
 // Returns a class factory to create an object of the requested type.
@@ -1,360 +0,0 @@
-
-
-/* this ALWAYS GENERATED file contains the proxy stub code */
-
-
- /* File created by MIDL compiler version 7.00.0555 */
-/* at Wed Oct 31 21:20:55 2012
- */
-/* Compiler settings for AComServer.idl:
-    Oicf, W1, Zp8, env=Win32 (32b run), target_arch=X86 7.00.0555 
-    protocol : dce , ms_ext, c_ext, robust
-    error checks: allocation ref bounds_check enum stub_data 
-    VC __declspec() decoration level: 
-         __declspec(uuid()), __declspec(selectany), __declspec(novtable)
-         DECLSPEC_UUID(), MIDL_INTERFACE()
-*/
-/* @@MIDL_FILE_HEADING(  ) */
-
-#if !defined(_M_IA64) && !defined(_M_AMD64)
-
-
-#pragma warning( disable: 4049 )  /* more than 64k source lines */
-#if _MSC_VER >= 1200
-#pragma warning(push)
-#endif
-
-#pragma warning( disable: 4211 )  /* redefine extern to static */
-#pragma warning( disable: 4232 )  /* dllimport identity*/
-#pragma warning( disable: 4024 )  /* array to pointer mapping*/
-#pragma warning( disable: 4152 )  /* function/data pointer conversion in expression */
-#pragma warning( disable: 4100 ) /* unreferenced arguments in x86 call */
-
-#pragma optimize("", off ) 
-
-#define USE_STUBLESS_PROXY
-
-
-/* verify that the <rpcproxy.h> version is high enough to compile this file*/
-#ifndef __REDQ_RPCPROXY_H_VERSION__
-#define __REQUIRED_RPCPROXY_H_VERSION__ 475
-#endif
-
-
-#include "rpcproxy.h"
-#ifndef __RPCPROXY_H_VERSION__
-#error this stub requires an updated version of <rpcproxy.h>
-#endif /* __RPCPROXY_H_VERSION__ */
-
-
-#include "AComServer_i.h"
-
-#define TYPE_FORMAT_STRING_SIZE   43                                
-#define PROC_FORMAT_STRING_SIZE   37                                
-#define EXPR_FORMAT_STRING_SIZE   1                                 
-#define TRANSMIT_AS_TABLE_SIZE    0            
-#define WIRE_MARSHAL_TABLE_SIZE   1            
-
-typedef struct _AComServer_MIDL_TYPE_FORMAT_STRING
-    {
-    short          Pad;
-    unsigned char  Format[ TYPE_FORMAT_STRING_SIZE ];
-    } AComServer_MIDL_TYPE_FORMAT_STRING;
-
-typedef struct _AComServer_MIDL_PROC_FORMAT_STRING
-    {
-    short          Pad;
-    unsigned char  Format[ PROC_FORMAT_STRING_SIZE ];
-    } AComServer_MIDL_PROC_FORMAT_STRING;
-
-typedef struct _AComServer_MIDL_EXPR_FORMAT_STRING
-    {
-    long          Pad;
-    unsigned char  Format[ EXPR_FORMAT_STRING_SIZE ];
-    } AComServer_MIDL_EXPR_FORMAT_STRING;
-
-
-static const RPC_SYNTAX_IDENTIFIER  _RpcTransferSyntax = 
-{{0x8A885D04,0x1CEB,0x11C9,{0x9F,0xE8,0x08,0x00,0x2B,0x10,0x48,0x60}},{2,0}};
-
-
-extern const AComServer_MIDL_TYPE_FORMAT_STRING AComServer__MIDL_TypeFormatString;
-extern const AComServer_MIDL_PROC_FORMAT_STRING AComServer__MIDL_ProcFormatString;
-extern const AComServer_MIDL_EXPR_FORMAT_STRING AComServer__MIDL_ExprFormatString;
-
-
-extern const MIDL_STUB_DESC Object_StubDesc;
-
-
-extern const MIDL_SERVER_INFO INicosComClass_ServerInfo;
-extern const MIDL_STUBLESS_PROXY_INFO INicosComClass_ProxyInfo;
-
-
-extern const USER_MARSHAL_ROUTINE_QUADRUPLE UserMarshalRoutines[ WIRE_MARSHAL_TABLE_SIZE ];
-
-#if !defined(__RPC_WIN32__)
-#error  Invalid build platform for this stub.
-#endif
-
-#if !(TARGET_IS_NT50_OR_LATER)
-#error You need Windows 2000 or later to run this stub because it uses these features:
-#error   /robust command line switch.
-#error However, your C/C++ compilation flags indicate you intend to run this app on earlier systems.
-#error This app will fail with the RPC_X_WRONG_STUB_VERSION error.
-#endif
-
-
-static const AComServer_MIDL_PROC_FORMAT_STRING AComServer__MIDL_ProcFormatString =
-    {
-        0,
-        {
-
-	/* Procedure GetData */
-
-			0x33,		/* FC_AUTO_HANDLE */
-			0x6c,		/* Old Flags:  object, Oi2 */
-/*  2 */	NdrFcLong( 0x0 ),	/* 0 */
-/*  6 */	NdrFcShort( 0x7 ),	/* 7 */
-/*  8 */	NdrFcShort( 0xc ),	/* x86 Stack size/offset = 12 */
-/* 10 */	NdrFcShort( 0x0 ),	/* 0 */
-/* 12 */	NdrFcShort( 0x8 ),	/* 8 */
-/* 14 */	0x45,		/* Oi2 Flags:  srv must size, has return, has ext, */
-			0x2,		/* 2 */
-/* 16 */	0x8,		/* 8 */
-			0x3,		/* Ext Flags:  new corr desc, clt corr check, */
-/* 18 */	NdrFcShort( 0x1 ),	/* 1 */
-/* 20 */	NdrFcShort( 0x0 ),	/* 0 */
-/* 22 */	NdrFcShort( 0x0 ),	/* 0 */
-
-	/* Parameter data */
-
-/* 24 */	NdrFcShort( 0x2113 ),	/* Flags:  must size, must free, out, simple ref, srv alloc size=8 */
-/* 26 */	NdrFcShort( 0x4 ),	/* x86 Stack size/offset = 4 */
-/* 28 */	NdrFcShort( 0x20 ),	/* Type Offset=32 */
-
-	/* Return value */
-
-/* 30 */	NdrFcShort( 0x70 ),	/* Flags:  out, return, base type, */
-/* 32 */	NdrFcShort( 0x8 ),	/* x86 Stack size/offset = 8 */
-/* 34 */	0x8,		/* FC_LONG */
-			0x0,		/* 0 */
-
-			0x0
-        }
-    };
-
-static const AComServer_MIDL_TYPE_FORMAT_STRING AComServer__MIDL_TypeFormatString =
-    {
-        0,
-        {
-			NdrFcShort( 0x0 ),	/* 0 */
-/*  2 */	
-			0x11, 0x4,	/* FC_RP [alloced_on_stack] */
-/*  4 */	NdrFcShort( 0x1c ),	/* Offset= 28 (32) */
-/*  6 */	
-			0x13, 0x0,	/* FC_OP */
-/*  8 */	NdrFcShort( 0xe ),	/* Offset= 14 (22) */
-/* 10 */	
-			0x1b,		/* FC_CARRAY */
-			0x1,		/* 1 */
-/* 12 */	NdrFcShort( 0x2 ),	/* 2 */
-/* 14 */	0x9,		/* Corr desc: FC_ULONG */
-			0x0,		/*  */
-/* 16 */	NdrFcShort( 0xfffc ),	/* -4 */
-/* 18 */	NdrFcShort( 0x1 ),	/* Corr flags:  early, */
-/* 20 */	0x6,		/* FC_SHORT */
-			0x5b,		/* FC_END */
-/* 22 */	
-			0x17,		/* FC_CSTRUCT */
-			0x3,		/* 3 */
-/* 24 */	NdrFcShort( 0x8 ),	/* 8 */
-/* 26 */	NdrFcShort( 0xfff0 ),	/* Offset= -16 (10) */
-/* 28 */	0x8,		/* FC_LONG */
-			0x8,		/* FC_LONG */
-/* 30 */	0x5c,		/* FC_PAD */
-			0x5b,		/* FC_END */
-/* 32 */	0xb4,		/* FC_USER_MARSHAL */
-			0x83,		/* 131 */
-/* 34 */	NdrFcShort( 0x0 ),	/* 0 */
-/* 36 */	NdrFcShort( 0x4 ),	/* 4 */
-/* 38 */	NdrFcShort( 0x0 ),	/* 0 */
-/* 40 */	NdrFcShort( 0xffde ),	/* Offset= -34 (6) */
-
-			0x0
-        }
-    };
-
-static const USER_MARSHAL_ROUTINE_QUADRUPLE UserMarshalRoutines[ WIRE_MARSHAL_TABLE_SIZE ] = 
-        {
-            
-            {
-            BSTR_UserSize
-            ,BSTR_UserMarshal
-            ,BSTR_UserUnmarshal
-            ,BSTR_UserFree
-            }
-
-        };
-
-
-
-/* Object interface: IUnknown, ver. 0.0,
-   GUID={0x00000000,0x0000,0x0000,{0xC0,0x00,0x00,0x00,0x00,0x00,0x00,0x46}} */
-
-
-/* Object interface: IDispatch, ver. 0.0,
-   GUID={0x00020400,0x0000,0x0000,{0xC0,0x00,0x00,0x00,0x00,0x00,0x00,0x46}} */
-
-
-/* Object interface: INicosComClass, ver. 0.0,
-   GUID={0x88B4EC6A,0x8A7C,0x4169,{0x98,0xCF,0x1F,0x60,0x0C,0x03,0xC2,0x48}} */
-
-#pragma code_seg(".orpc")
-static const unsigned short INicosComClass_FormatStringOffsetTable[] =
-    {
-    (unsigned short) -1,
-    (unsigned short) -1,
-    (unsigned short) -1,
-    (unsigned short) -1,
-    0
-    };
-
-static const MIDL_STUBLESS_PROXY_INFO INicosComClass_ProxyInfo =
-    {
-    &Object_StubDesc,
-    AComServer__MIDL_ProcFormatString.Format,
-    &INicosComClass_FormatStringOffsetTable[-3],
-    0,
-    0,
-    0
-    };
-
-
-static const MIDL_SERVER_INFO INicosComClass_ServerInfo = 
-    {
-    &Object_StubDesc,
-    0,
-    AComServer__MIDL_ProcFormatString.Format,
-    &INicosComClass_FormatStringOffsetTable[-3],
-    0,
-    0,
-    0,
-    0};
-CINTERFACE_PROXY_VTABLE(8) _INicosComClassProxyVtbl = 
-{
-    &INicosComClass_ProxyInfo,
-    &IID_INicosComClass,
-    IUnknown_QueryInterface_Proxy,
-    IUnknown_AddRef_Proxy,
-    IUnknown_Release_Proxy ,
-    0 /* IDispatch::GetTypeInfoCount */ ,
-    0 /* IDispatch::GetTypeInfo */ ,
-    0 /* IDispatch::GetIDsOfNames */ ,
-    0 /* IDispatch_Invoke_Proxy */ ,
-    (void *) (INT_PTR) -1 /* INicosComClass::GetData */
-};
-
-
-static const PRPC_STUB_FUNCTION INicosComClass_table[] =
-{
-    STUB_FORWARDING_FUNCTION,
-    STUB_FORWARDING_FUNCTION,
-    STUB_FORWARDING_FUNCTION,
-    STUB_FORWARDING_FUNCTION,
-    NdrStubCall2
-};
-
-CInterfaceStubVtbl _INicosComClassStubVtbl =
-{
-    &IID_INicosComClass,
-    &INicosComClass_ServerInfo,
-    8,
-    &INicosComClass_table[-3],
-    CStdStubBuffer_DELEGATING_METHODS
-};
-
-static const MIDL_STUB_DESC Object_StubDesc = 
-    {
-    0,
-    NdrOleAllocate,
-    NdrOleFree,
-    0,
-    0,
-    0,
-    0,
-    0,
-    AComServer__MIDL_TypeFormatString.Format,
-    1, /* -error bounds_check flag */
-    0x50002, /* Ndr library version */
-    0,
-    0x700022b, /* MIDL Version 7.0.555 */
-    0,
-    UserMarshalRoutines,
-    0,  /* notify & notify_flag routine table */
-    0x1, /* MIDL flag */
-    0, /* cs routines */
-    0,   /* proxy/server info */
-    0
-    };
-
-const CInterfaceProxyVtbl * const _AComServer_ProxyVtblList[] = 
-{
-    ( CInterfaceProxyVtbl *) &_INicosComClassProxyVtbl,
-    0
-};
-
-const CInterfaceStubVtbl * const _AComServer_StubVtblList[] = 
-{
-    ( CInterfaceStubVtbl *) &_INicosComClassStubVtbl,
-    0
-};
-
-PCInterfaceName const _AComServer_InterfaceNamesList[] = 
-{
-    "INicosComClass",
-    0
-};
-
-const IID *  const _AComServer_BaseIIDList[] = 
-{
-    &IID_IDispatch,
-    0
-};
-
-
-#define _AComServer_CHECK_IID(n)	IID_GENERIC_CHECK_IID( _AComServer, pIID, n)
-
-int __stdcall _AComServer_IID_Lookup( const IID * pIID, int * pIndex )
-{
-    
-    if(!_AComServer_CHECK_IID(0))
-        {
-        *pIndex = 0;
-        return 1;
-        }
-
-    return 0;
-}
-
-const ExtendedProxyFileInfo AComServer_ProxyFileInfo = 
-{
-    (PCInterfaceProxyVtblList *) & _AComServer_ProxyVtblList,
-    (PCInterfaceStubVtblList *) & _AComServer_StubVtblList,
-    (const PCInterfaceName * ) & _AComServer_InterfaceNamesList,
-    (const IID ** ) & _AComServer_BaseIIDList,
-    & _AComServer_IID_Lookup, 
-    1,
-    2,
-    0, /* table of [async_uuid] interfaces */
-    0, /* Filler1 */
-    0, /* Filler2 */
-    0  /* Filler3 */
-};
-#pragma optimize("", on )
-#if _MSC_VER >= 1200
-#pragma warning(pop)
-#endif
-
-
-#endif /* !defined(_M_IA64) && !defined(_M_AMD64)*/
-
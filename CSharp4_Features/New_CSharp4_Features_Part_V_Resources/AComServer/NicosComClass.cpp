@@ -2,16 +2,409 @@
 
 #include "stdafx.h"
 #include "NicosComClass.h"
+#include "NicosDataCall.h"
+#include "NicosDataEnumerator.h"
+
+
+namespace
+{
+	// The names of the methods of INicosComClass2 in a hash table, which ignores the case of the
+	// names (as Basic does). It's built when the DLL is loaded and only read afterwards.
+	class DispatchNameTable
+	{
+	public:
+		DispatchNameTable()
+		{
+			static const Entry entries[] =
+			{
+				{L"GetData", DISPID_NICOSCOMCLASS_GETDATA, 0, NULL},
+				{L"GetDataBatch", DISPID_NICOSCOMCLASS_GETDATABATCH, 0, NULL}
+			};
+			static_assert(_countof(entries) == _countof(m_entries),
+				"m_entries must hold an entry for each name!");
+			memset(m_buckets, 0, sizeof(m_buckets));
+			for (size_t entry(0); entry < _countof(entries); ++entry)
+			{
+				m_entries[entry] = entries[entry];
+				m_entries[entry].hash = Hash(m_entries[entry].name);
+				const Entry*& bucket(m_buckets[m_entries[entry].hash % BucketCount]);
+				m_entries[entry].next = bucket;
+				bucket = &m_entries[entry];
+			}
+		}
+
+		// Returns the DISPID of name, or DISPID_UNKNOWN.
+		DISPID Find(LPCOLESTR name) const
+		{
+			const ULONG hash(Hash(name));
+			for (const Entry* entry(m_buckets[hash % BucketCount]); entry; entry = entry->next)
+			{
+				if (hash == entry->hash && 0 == _wcsicmp(name, entry->name))
+				{
+					return entry->dispId;
+				}
+			}
+			return DISPID_UNKNOWN;
+		}
+
+	private:
+		struct Entry
+		{
+			LPCOLESTR name;
+			DISPID dispId;
+			ULONG hash;
+			const Entry* next;
+		};
+
+		// FNV-1a of the characters, ASCII letters folded to lower case.
+		static ULONG Hash(LPCOLESTR name)
+		{
+			ULONG hash(2166136261u);
+			for (; *name; ++name)
+			{
+				const OLECHAR character(L'A' <= *name && *name <= L'Z'
+					? static_cast<OLECHAR>(*name - L'A' + L'a') : *name);
+				hash = (hash ^ character) * 16777619u;
+			}
+			return hash;
+		}
+
+		static const size_t BucketCount = 16;
+
+		// One for each name in the constructor, which checks the size.
+		Entry m_entries[2];
+		const Entry* m_buckets[BucketCount];
+	};
+
+	const DispatchNameTable dispatchNames;
+}
 
 
 // CNicosComClass
 
 
 
+STDMETHODIMP CNicosComClass::GetIDsOfNames(REFIID riid, LPOLESTR* rgszNames, UINT cNames,
+	LCID /*lcid*/, DISPID* rgdispid)
+{
+	CStatsCall call(StatsGetIDsOfNames);
+	if (IID_NULL != riid)
+	{
+		return DISP_E_UNKNOWNINTERFACE;
+	}
+	if (!rgszNames || !rgdispid)
+	{
+		return E_POINTER;
+	}
+
+	// The names of the arguments (after the name of the method) are unknown, as Invoke() doesn't
+	// support named arguments.
+	HRESULT hr = S_OK;
+	for (UINT name(0); name < cNames; ++name)
+	{
+		rgdispid[name] = 0 == name && rgszNames[0]
+			? dispatchNames.Find(rgszNames[0])
+			: DISPID_UNKNOWN;
+		if (DISPID_UNKNOWN == rgdispid[name])
+		{
+			hr = DISP_E_UNKNOWNNAME;
+		}
+	}
+
+	return hr;
+}
+
+
+STDMETHODIMP CNicosComClass::Invoke(DISPID dispidMember, REFIID riid, LCID /*lcid*/,
+	WORD wFlags, DISPPARAMS* pdispparams, VARIANT* pvarResult, EXCEPINFO* /*pexcepinfo*/,
+	UINT* puArgErr)
+{
+	CStatsCall call(StatsInvoke);
+	if (IID_NULL != riid)
+	{
+		return DISP_E_UNKNOWNINTERFACE;
+	}
+	if (!pdispparams)
+	{
+		return E_POINTER;
+	}
+	// The methods can be called as methods or as read-only properties (as the type library allows).
+	if (!(wFlags & (DISPATCH_METHOD | DISPATCH_PROPERTYGET)))
+	{
+		return DISP_E_MEMBERNOTFOUND;
+	}
+	if (0 != pdispparams->cNamedArgs)
+	{
+		return DISP_E_NONAMEDARGS;
+	}
+
+	switch (dispidMember)
+	{
+	case DISPID_NICOSCOMCLASS_GETDATA:
+		{
+			if (0 != pdispparams->cArgs)
+			{
+				return DISP_E_BADPARAMCOUNT;
+			}
+			BSTR data(NULL);
+			const HRESULT hr = GetData(&data);
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+			if (pvarResult)
+			{
+				VariantInit(pvarResult);
+				pvarResult->vt = VT_BSTR;
+				pvarResult->bstrVal = data;
+			}
+			else
+			{
+				SysFreeString(data);
+			}
+			return S_OK;
+		}
+	case DISPID_NICOSCOMCLASS_GETDATABATCH:
+		{
+			if (1 != pdispparams->cArgs)
+			{
+				return DISP_E_BADPARAMCOUNT;
+			}
+			// Accepts any argument convertible to a LONG, also by reference (as Basic passes it).
+			CComVariant count;
+			if (FAILED(VariantChangeType(&count, &pdispparams->rgvarg[0], 0, VT_I4)))
+			{
+				if (puArgErr)
+				{
+					*puArgErr = 0;
+				}
+				return DISP_E_TYPEMISMATCH;
+			}
+			SAFEARRAY* data(NULL);
+			const HRESULT hr = GetDataBatch(count.lVal, &data);
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+			if (pvarResult)
+			{
+				VariantInit(pvarResult);
+				pvarResult->vt = VT_ARRAY | VT_BSTR;
+				pvarResult->parray = data;
+			}
+			else
+			{
+				SafeArrayDestroy(data);
+			}
+			return S_OK;
+		}
+	default:
+		return DISP_E_MEMBERNOTFOUND;
+	}
+}
+
+
 STDMETHODIMP CNicosComClass::GetData(BSTR* data)
 {
-	// TODO: Add your implementation code here
-	*data = SysAllocString(L"Hello World!");
+	// A BSTR passed out must be allocated for the caller, but copying the cached data is cheaper
+	// than building it: its length is known (and the system caches small BSTRs).
+	CStatsCall call(StatsGetData);
+	const HRESULT hr = m_data.CopyTo(data);
+	if (SUCCEEDED(hr))
+	{
+		call.AddBytes(m_data.ByteLength());
+	}
+
+	return hr;
+}
+
+
+// Returns count copies of the data as one SAFEARRAY, which is marshaled with one round trip.
+STDMETHODIMP CNicosComClass::GetDataBatch(LONG count, SAFEARRAY** data)
+{
+	CStatsCall call(StatsGetDataBatch);
+	if (!data)
+	{
+		return E_POINTER;
+	}
+	*data = NULL;
+	if (count < 0)
+	{
+		return E_INVALIDARG;
+	}
+
+	SAFEARRAY* const batch(SafeArrayCreateVector(VT_BSTR, 0, count));
+	if (!batch)
+	{
+		return E_OUTOFMEMORY;
+	}
+	BSTR* items(NULL);
+	HRESULT hr = SafeArrayAccessData(batch, reinterpret_cast<void**>(&items));
+	for (LONG item(0); SUCCEEDED(hr) && item < count; ++item)
+	{
+		items[item] = m_data.Copy();
+		if (!items[item])
+		{
+			hr = E_OUTOFMEMORY;
+		}
+	}
+	if (items)
+	{
+		SafeArrayUnaccessData(batch);
+	}
+	if (FAILED(hr))
+	{
+		// Frees the BSTRs copied so far as well.
+		SafeArrayDestroy(batch);
+		return hr;
+	}
+	*data = batch;
+	call.AddBytes(static_cast<ULONGLONG>(count) * m_data.ByteLength());
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CNicosComClass::GetDataLength(ULONG* length)
+{
+	if (!length)
+	{
+		return E_POINTER;
+	}
+	*length = m_data.Length();
+
+	return S_OK;
+}
+
+
+// Copies as many characters of the data as fit into buffer (without a terminating 0), returns
+// S_FALSE, if the data was truncated.
+STDMETHODIMP CNicosComClass::CopyData(ULONG capacity, OLECHAR* buffer, ULONG* length)
+{
+	CStatsCall call(StatsCopyData);
+	if (!length || (!buffer && 0 != capacity))
+	{
+		return E_POINTER;
+	}
+	const ULONG dataLength(m_data.Length());
+	*length = capacity < dataLength ? capacity : dataLength;
+	memcpy(buffer, m_data.m_str, *length * sizeof(OLECHAR));
+	call.AddBytes(*length * sizeof(OLECHAR));
+
+	return *length == dataLength ? S_OK : S_FALSE;
+}
+
+
+// Clients in other apartments or processes receive a proxy of the enumerator, so one Next() call
+// fetches a batch of strings with one round trip (see "NicosDataEnumerator.h").
+STDMETHODIMP CNicosComClass::EnumData(ULONG count, IEnumString** enumerator)
+{
+	return CNicosDataEnumerator::Create(m_data, count, 0, enumerator);
+}
+
+
+// Returns the name of a file mapping, which holds the data (the OLECHARs without a terminating 0)
+// at offset, size bytes long. Clients (also in other processes of the session) open it with
+// OpenFileMapping(FILE_MAP_READ, ...) and read the data in place, instead of receiving a copy
+// marshaled through RPC. The mapping lives as long as this object or a handle of a client.
+// Clients in other processes create the object with CLSCTX_LOCAL_SERVER: the AppID of the server
+// (see AComServer.rgs) names the default DLL surrogate, and the merged proxy/stub marshals
+// INicosComClassNative.
+STDMETHODIMP CNicosComClass::GetDataSection(BSTR* name, ULONG* offset, ULONG* size)
+{
+	CStatsCall call(StatsGetDataSection);
+	if (!name || !offset || !size)
+	{
+		return E_POINTER;
+	}
+	*name = NULL;
+
+	ObjectLock lock(this);
+	if (!m_sectionName)
+	{
+		const HRESULT hr = CreateDataSection();
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+	}
+	*offset = 0;
+	*size = m_data.ByteLength();
+
+	return m_sectionName.CopyTo(name);
+}
+
+
+// Creates a file mapping with a unique name and copies the data into it.
+HRESULT CNicosComClass::CreateDataSection()
+{
+	GUID id;
+	HRESULT hr = CoCreateGuid(&id);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	OLECHAR idText[40];
+	if (!StringFromGUID2(id, idText, _countof(idText)))
+	{
+		return E_UNEXPECTED;
+	}
+	CComBSTR sectionName;
+	hr = sectionName.Append(L"Local\\NicosComClassData");
+	if (SUCCEEDED(hr))
+	{
+		hr = sectionName.Append(idText);
+	}
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// A file mapping can't be empty.
+	const ULONG size(m_data.ByteLength());
+	hr = m_section.MapSharedMem(0 != size ? size : 1, sectionName);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	memcpy(m_section.GetData(), m_data.m_str, size);
+	m_sectionName.Attach(sectionName.Detach());
 
 	return S_OK;
 }
+
+
+// Creates the server side call object of AsyncINicosDataSource. COM's stub calls it with its own
+// call object as pCtrlUnk, when a client calls asynchronously through the proxy from another
+// apartment or process (the proxy/stub is merged into this DLL, see _MERGE_PROXYSTUB). Clients
+// calling the object directly (in the same apartment, or in any apartment in the free threaded
+// build, where the free threaded marshaler passes the object's pointer unmarshaled) get this
+// ICallFactory from QueryInterface() as well, but asynchronous calls aren't supported for them:
+// CreateCall() returns CO_E_NOT_SUPPORTED, if pCtrlUnk is NULL or doesn't implement ISynchronize
+// (which the call object signals on completion). They call INicosDataSource::GetData() instead.
+STDMETHODIMP CNicosComClass::CreateCall(REFIID riid, IUnknown* pCtrlUnk, REFIID riid2,
+	IUnknown** ppv)
+{
+	if (!ppv)
+	{
+		return E_POINTER;
+	}
+	*ppv = NULL;
+	if (IID_AsyncINicosDataSource != riid)
+	{
+		return E_NOINTERFACE;
+	}
+	CComPtr<ISynchronize> synchronize;
+	if (!pCtrlUnk || FAILED(pCtrlUnk->QueryInterface(&synchronize)))
+	{
+		return CO_E_NOT_SUPPORTED;
+	}
+	synchronize.Release();
+	// An aggregated object must return its inner IUnknown.
+	if (IID_IUnknown != riid2)
+	{
+		return E_INVALIDARG;
+	}
+
+	return CNicosDataCall::Create(pCtrlUnk, m_data, ppv);
+}
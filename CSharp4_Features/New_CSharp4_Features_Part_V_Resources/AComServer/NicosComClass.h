@@ -6,6 +6,8 @@
 
 
 #include "AComServer_i.h"
+#include "PooledClassFactory.h"
+#include "ServerStats.h"
 
 
 
@@ -16,37 +18,139 @@
 using namespace ATL;
 
 
+// The threading model of CNicosComClass, see ACOMSERVER_FREE_THREADED in stdafx.h.
+#ifdef ACOMSERVER_FREE_THREADED
+typedef CComMultiThreadModel NicosComClassThreadModel;
+#define NICOSCOMCLASS_THREADINGMODEL L"Both"
+#else
+typedef CComSingleThreadModel NicosComClassThreadModel;
+#define NICOSCOMCLASS_THREADINGMODEL L"Apartment"
+#endif
+
+// The pool is shared by all apartments of the process, see PooledClassFactory.h.
+#if defined(ACOMSERVER_POOLED_OBJECTS) && !defined(ACOMSERVER_FREE_THREADED)
+#error "ACOMSERVER_POOLED_OBJECTS requires ACOMSERVER_FREE_THREADED: apartment threaded objects can't be pooled."
+#endif
+
+
+// The DISPIDs of the methods of INicosComClass2, as declared in AComServer.idl.
+enum
+{
+	DISPID_NICOSCOMCLASS_GETDATA = 1,
+	DISPID_NICOSCOMCLASS_GETDATABATCH = 2
+};
+
+
 // CNicosComClass
+// IDispatchImpl provides the type information, but the late bound calls don't go through it:
+// GetIDsOfNames() looks the names up in a hash table and Invoke() calls the methods directly,
+// instead of letting ITypeInfo::Invoke() interpret the type library on each call.
+// In the free threaded build, the methods are called on any thread concurrently: state must be
+// guarded (with ObjectLock or Interlocked*()), and interface pointers to objects of other
+// apartments mustn't be held, because the free threaded marshaler passes this object's pointer
+// unmarshaled into all apartments of the process.
+// Define ACOMSERVER_POOLED_OBJECTS (in the free threaded build) to recycle the released objects,
+// see PooledClassFactory.h.
 
 class ATL_NO_VTABLE CNicosComClass :
-	public CComObjectRootEx<CComSingleThreadModel>,
+	public CComObjectRootEx<NicosComClassThreadModel>,
 	public CComCoClass<CNicosComClass, &CLSID_NicosComClass>,
-	public IDispatchImpl<INicosComClass, &IID_INicosComClass, &LIBID_AComServerLib, /*wMajor =*/ 1, /*wMinor =*/ 0>
+	public IDispatchImpl<INicosComClass2, &IID_INicosComClass2, &LIBID_AComServerLib, /*wMajor =*/ 1, /*wMinor =*/ 0>,
+	public INicosComClassNative,
+	public INicosDataSource,
+	public ICallFactory,
+	public IAComServerStatsImpl
 {
 public:
 	CNicosComClass()
 	{
 	}
 
-DECLARE_REGISTRY_RESOURCEID(IDR_NICOSCOMCLASS)
+#ifdef ACOMSERVER_POOLED_OBJECTS
+	DECLARE_CLASSFACTORY_EX(CPooledClassFactory<CNicosComClass>)
+#endif
+
+	// Registers the class with the threading model of the build.
+	static HRESULT WINAPI UpdateRegistry(BOOL bRegister)
+	{
+		_ATL_REGMAP_ENTRY regMapEntries[] =
+		{
+			{L"THREADINGMODEL", NICOSCOMCLASS_THREADINGMODEL},
+			{NULL, NULL}
+		};
+		return ATL::_pAtlModule->UpdateRegistryFromResource(IDR_NICOSCOMCLASS, bRegister,
+			regMapEntries);
+	}
 
 
 BEGIN_COM_MAP(CNicosComClass)
+	COM_INTERFACE_ENTRY(INicosComClass2)
 	COM_INTERFACE_ENTRY(INicosComClass)
 	COM_INTERFACE_ENTRY(IDispatch)
+	COM_INTERFACE_ENTRY(INicosComClassNative)
+	COM_INTERFACE_ENTRY(INicosDataSource)
+	COM_INTERFACE_ENTRY(ICallFactory)
+	COM_INTERFACE_ENTRY(IAComServerStats)
+#ifdef ACOMSERVER_FREE_THREADED
+	COM_INTERFACE_ENTRY_AGGREGATE(IID_IMarshal, m_pUnkMarshaler.p)
+#endif
 END_COM_MAP()
 
+#ifdef ACOMSERVER_FREE_THREADED
+	DECLARE_GET_CONTROLLING_UNKNOWN()
+#endif
+
 
 
 	DECLARE_PROTECT_FINAL_CONSTRUCT()
 
 	HRESULT FinalConstruct()
 	{
+		// The data is built once and only read afterwards, so all threads share it without a lock.
+		m_data.Attach(SysAllocString(L"Hello World!"));
+		if (!m_data)
+		{
+			return E_OUTOFMEMORY;
+		}
+#ifndef ACOMSERVER_POOLED_OBJECTS
+		// A pooled object is counted on each Activate().
+		CServerStats::RecordActivation();
+#endif
+#ifdef ACOMSERVER_FREE_THREADED
+		return CoCreateFreeThreadedMarshaler(GetControllingUnknown(), &m_pUnkMarshaler.p);
+#else
 		return S_OK;
+#endif
 	}
 
 	void FinalRelease()
 	{
+		m_section.Unmap();
+		m_data.Empty();
+#ifdef ACOMSERVER_FREE_THREADED
+		m_pUnkMarshaler.Release();
+#endif
+	}
+
+#ifdef ACOMSERVER_FREE_THREADED
+	CComPtr<IUnknown> m_pUnkMarshaler;
+#endif
+
+	// The hooks of CComPooledObject: the state of an object (the data and its section) doesn't
+	// depend on the client, so a released object is reused as it is.
+	HRESULT Activate()
+	{
+		CServerStats::RecordActivation();
+		return S_OK;
+	}
+
+	void Deactivate()
+	{
+	}
+
+	bool CanBePooled() const
+	{
+		return true;
 	}
 
 public:
@@ -54,6 +158,32 @@ public:
 
 
 	STDMETHOD(GetData)(BSTR* data);
+	STDMETHOD(GetDataBatch)(LONG count, SAFEARRAY** data);
+
+	// IDispatch
+	STDMETHOD(GetIDsOfNames)(REFIID riid, LPOLESTR* rgszNames, UINT cNames, LCID lcid,
+		DISPID* rgdispid);
+	STDMETHOD(Invoke)(DISPID dispidMember, REFIID riid, LCID lcid, WORD wFlags,
+		DISPPARAMS* pdispparams, VARIANT* pvarResult, EXCEPINFO* pexcepinfo, UINT* puArgErr);
+
+	// INicosComClassNative
+	STDMETHOD(GetDataLength)(ULONG* length);
+	STDMETHOD(CopyData)(ULONG capacity, OLECHAR* buffer, ULONG* length);
+	STDMETHOD(EnumData)(ULONG count, IEnumString** enumerator);
+	STDMETHOD(GetDataSection)(BSTR* name, ULONG* offset, ULONG* size);
+
+	// INicosDataSource: GetData() above implements it as well.
+
+	// ICallFactory: only for COM's stub, see CreateCall().
+	STDMETHOD(CreateCall)(REFIID riid, IUnknown* pCtrlUnk, REFIID riid2, IUnknown** ppv);
+
+private:
+	HRESULT CreateDataSection();
+
+	CComBSTR m_data;
+	// The file mapping of GetDataSection(), created on the first call.
+	CAtlFileMapping<char> m_section;
+	CComBSTR m_sectionName;
 };
 
 OBJECT_ENTRY_AUTO(__uuidof(NicosComClass), CNicosComClass)
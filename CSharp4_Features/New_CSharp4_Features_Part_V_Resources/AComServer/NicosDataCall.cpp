@@ -0,0 +1,138 @@
+// NicosDataCall.cpp : Implementation of CNicosDataCall
+
+#include "stdafx.h"
+#include "NicosDataCall.h"
+
+
+// CNicosDataCall
+
+
+
+HRESULT CNicosDataCall::Create(IUnknown* outer, const CComBSTR& source, IUnknown** call)
+{
+	if (!call)
+	{
+		return E_POINTER;
+	}
+	*call = NULL;
+	// Call objects are always aggregated.
+	if (!outer)
+	{
+		return E_INVALIDARG;
+	}
+
+	CComAggObject<CNicosDataCall>* object(NULL);
+	HRESULT hr = CComAggObject<CNicosDataCall>::CreateInstance(outer, &object);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	hr = source.CopyTo(&object->m_contained.m_source);
+	if (FAILED(hr))
+	{
+		delete object;
+		return hr;
+	}
+
+	// Returns the inner IUnknown (the one which isn't delegating to outer).
+	return object->QueryInterface(IID_IUnknown, reinterpret_cast<void**>(call));
+}
+
+
+STDMETHODIMP CNicosDataCall::Begin_GetData()
+{
+	ObjectLock lock(this);
+	if (m_pending)
+	{
+		return RPC_E_CALL_PENDING;
+	}
+	SysFreeString(m_data);
+	m_data = NULL;
+	m_result = E_PENDING;
+	m_pending = true;
+	m_start = CServerStats::IsEnabled() ? CServerStats::Now() : 0;
+	ResetEvent(m_completed);
+
+	// The work holds the call object until it's done.
+	GetControllingUnknown()->AddRef();
+	if (!QueueUserWorkItem(GetDataWork, this, WT_EXECUTEDEFAULT))
+	{
+		const HRESULT hr(AtlHresultFromLastError());
+		m_pending = false;
+		SetEvent(m_completed);
+		GetControllingUnknown()->Release();
+		return hr;
+	}
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CNicosDataCall::Finish_GetData(BSTR* data)
+{
+	if (!data)
+	{
+		return E_POINTER;
+	}
+	*data = NULL;
+
+	{
+		ObjectLock lock(this);
+		if (!m_pending)
+		{
+			return RPC_E_CALL_COMPLETE;
+		}
+	}
+	// Pumps messages, if the caller is in an STA.
+	HANDLE completed(m_completed);
+	DWORD index(0);
+	const HRESULT waited(CoWaitForMultipleHandles(0, INFINITE, 1, &completed, &index));
+	if (FAILED(waited))
+	{
+		return waited;
+	}
+
+	ObjectLock lock(this);
+	m_pending = false;
+	*data = m_data;
+	m_data = NULL;
+
+	return m_result;
+}
+
+
+// Copies the data and completes the call. The thread of the pool joins the MTA, as it calls COM's
+// call object: a process with only STAs has no implicit MTA, which the thread would belong to.
+DWORD WINAPI CNicosDataCall::GetDataWork(LPVOID parameter)
+{
+	const HRESULT initialized(CoInitializeEx(NULL, COINIT_MULTITHREADED));
+	CNicosDataCall* const call(static_cast<CNicosDataCall*>(parameter));
+	BSTR data(NULL);
+	const HRESULT hr = call->m_source.CopyTo(&data);
+	{
+		ObjectLock lock(call);
+		call->m_result = hr;
+		call->m_data = data;
+		if (0 != call->m_start)
+		{
+			CServerStats::RecordCall(StatsAsyncGetData, call->m_start, SysStringByteLen(data));
+		}
+	}
+	SetEvent(call->m_completed);
+
+	// Lets COM's call object send the reply.
+	IUnknown* const outer(call->GetControllingUnknown());
+	CComPtr<ISynchronize> synchronize;
+	if (SUCCEEDED(outer->QueryInterface(&synchronize)))
+	{
+		synchronize->Signal();
+	}
+	synchronize.Release();
+	outer->Release();
+
+	if (SUCCEEDED(initialized))
+	{
+		CoUninitialize();
+	}
+	return 0;
+}
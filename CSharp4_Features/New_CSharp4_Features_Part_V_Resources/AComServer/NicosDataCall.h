@@ -0,0 +1,77 @@
+// NicosDataCall.h : Declaration of the CNicosDataCall
+
+#pragma once
+#include "resource.h"       // main symbols
+
+
+
+#include "AComServer_i.h"
+#include "ServerStats.h"
+
+
+// CNicosDataCall
+// The server side call object of AsyncINicosDataSource, which CNicosComClass::CreateCall()
+// creates aggregated into COM's call object. Begin_GetData() returns at once and copies the data
+// on a thread of the thread pool, Finish_GetData() waits for it and returns it. On completion the
+// call signals ISynchronize of the outer object, so COM sends the reply, while the thread of the
+// server isn't blocked. The call object is used from any thread, so it's always thread-safe.
+// The call object doesn't refer to the CNicosComClass: that one may be apartment threaded (with a
+// reference count, which isn't atomic), and must not be used or released on the thread pool.
+// Instead it gets its own copy of the (immutable) data of the object on creation.
+
+class ATL_NO_VTABLE CNicosDataCall :
+	public CComObjectRootEx<CComMultiThreadModel>,
+	public AsyncINicosDataSource
+{
+public:
+	CNicosDataCall()
+		: m_pending(false), m_result(E_UNEXPECTED), m_data(NULL), m_start(0)
+	{
+	}
+
+BEGIN_COM_MAP(CNicosDataCall)
+	COM_INTERFACE_ENTRY(AsyncINicosDataSource)
+END_COM_MAP()
+
+	DECLARE_GET_CONTROLLING_UNKNOWN()
+
+	DECLARE_PROTECT_FINAL_CONSTRUCT()
+
+	HRESULT FinalConstruct()
+	{
+		// Manual reset and signaled: no call is pending.
+		m_completed.Attach(CreateEvent(NULL, TRUE, TRUE, NULL));
+		return m_completed ? S_OK : AtlHresultFromLastError();
+	}
+
+	void FinalRelease()
+	{
+		// A pending call holds a reference, so the call is complete here.
+		SysFreeString(m_data);
+		m_data = NULL;
+		m_source.Empty();
+	}
+
+	// Creates a call object aggregated into outer, which returns a copy of source.
+	static HRESULT Create(IUnknown* outer, const CComBSTR& source, IUnknown** call);
+
+public:
+
+
+
+	// AsyncINicosDataSource
+	STDMETHOD(Begin_GetData)();
+	STDMETHOD(Finish_GetData)(BSTR* data);
+
+private:
+	static DWORD WINAPI GetDataWork(LPVOID parameter);
+
+	// The data of the object, which is only read after Create().
+	CComBSTR m_source;
+	CHandle m_completed;
+	bool m_pending;
+	HRESULT m_result;
+	BSTR m_data;
+	// The start of the pending call for CServerStats, or 0.
+	LONGLONG m_start;
+};
@@ -0,0 +1,113 @@
+// NicosDataEnumerator.cpp : Implementation of CNicosDataEnumerator
+
+#include "stdafx.h"
+#include "NicosDataEnumerator.h"
+
+
+// CNicosDataEnumerator
+
+
+
+HRESULT CNicosDataEnumerator::Create(const CComBSTR& data, ULONG count, ULONG position,
+	IEnumString** enumerator)
+{
+	if (!enumerator)
+	{
+		return E_POINTER;
+	}
+	*enumerator = NULL;
+
+	CComObject<CNicosDataEnumerator>* object(NULL);
+	HRESULT hr = CComObject<CNicosDataEnumerator>::CreateInstance(&object);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	// Holds the new object, so it's destroyed on failure.
+	CComPtr<IEnumString> result(object);
+	object->m_data.Attach(data.Copy());
+	if (!object->m_data && data)
+	{
+		return E_OUTOFMEMORY;
+	}
+	object->m_count = count;
+	object->m_position = position < count ? position : count;
+	*enumerator = result.Detach();
+
+	return S_OK;
+}
+
+
+// Returns the strings allocated with CoTaskMemAlloc(), the caller frees them with CoTaskMemFree().
+STDMETHODIMP CNicosDataEnumerator::Next(ULONG celt, LPOLESTR* rgelt, ULONG* pceltFetched)
+{
+	// pceltFetched may only be NULL, if one string is requested.
+	if (!rgelt || (!pceltFetched && 1 != celt))
+	{
+		return E_POINTER;
+	}
+
+	CStatsCall call(StatsEnumNext);
+	ObjectLock lock(this);
+	const OLECHAR* const text(m_data ? m_data.m_str : L"");
+	const SIZE_T size((m_data.Length() + 1) * sizeof(OLECHAR));
+	ULONG fetched(0);
+	for (; fetched < celt && m_position < m_count; ++fetched, ++m_position)
+	{
+		rgelt[fetched] = static_cast<LPOLESTR>(CoTaskMemAlloc(size));
+		if (!rgelt[fetched])
+		{
+			// Fetch all or nothing.
+			for (ULONG item(0); item < fetched; ++item)
+			{
+				CoTaskMemFree(rgelt[item]);
+				rgelt[item] = NULL;
+			}
+			m_position -= fetched;
+			if (pceltFetched)
+			{
+				*pceltFetched = 0;
+			}
+			return E_OUTOFMEMORY;
+		}
+		memcpy(rgelt[fetched], text, size);
+	}
+	call.AddBytes(static_cast<ULONGLONG>(fetched) * size);
+	if (pceltFetched)
+	{
+		*pceltFetched = fetched;
+	}
+
+	return fetched == celt ? S_OK : S_FALSE;
+}
+
+
+STDMETHODIMP CNicosDataEnumerator::Skip(ULONG celt)
+{
+	ObjectLock lock(this);
+	if (m_count - m_position < celt)
+	{
+		m_position = m_count;
+		return S_FALSE;
+	}
+	m_position += celt;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CNicosDataEnumerator::Reset()
+{
+	ObjectLock lock(this);
+	m_position = 0;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CNicosDataEnumerator::Clone(IEnumString** ppenum)
+{
+	ObjectLock lock(this);
+
+	return Create(m_data, m_count, m_position, ppenum);
+}
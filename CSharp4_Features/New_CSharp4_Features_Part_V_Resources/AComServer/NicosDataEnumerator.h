@@ -0,0 +1,49 @@
+// NicosDataEnumerator.h : Declaration of the CNicosDataEnumerator
+
+#pragma once
+#include "NicosComClass.h"
+#include "ServerStats.h"
+
+
+// CNicosDataEnumerator
+// Enumerates count copies of the data of a CNicosComClass as IEnumString. Next() returns up to
+// celt strings with one call, so a client in another apartment or process pays one round trip for
+// many strings. It isn't createable, CNicosComClass::EnumData() creates it.
+
+class ATL_NO_VTABLE CNicosDataEnumerator :
+	public CComObjectRootEx<NicosComClassThreadModel>,
+	public IEnumString
+{
+public:
+	CNicosDataEnumerator()
+		: m_count(0), m_position(0)
+	{
+	}
+
+BEGIN_COM_MAP(CNicosDataEnumerator)
+	COM_INTERFACE_ENTRY(IEnumString)
+END_COM_MAP()
+
+
+
+	DECLARE_PROTECT_FINAL_CONSTRUCT()
+
+	// Creates an enumerator of count copies of data, which starts at position.
+	static HRESULT Create(const CComBSTR& data, ULONG count, ULONG position,
+		IEnumString** enumerator);
+
+public:
+
+
+
+	// IEnumString
+	STDMETHOD(Next)(ULONG celt, LPOLESTR* rgelt, ULONG* pceltFetched);
+	STDMETHOD(Skip)(ULONG celt);
+	STDMETHOD(Reset)();
+	STDMETHOD(Clone)(IEnumString** ppenum);
+
+private:
+	CComBSTR m_data;
+	ULONG m_count;
+	ULONG m_position;
+};
@@ -0,0 +1,207 @@
+// PooledClassFactory.h : Declaration of CPooledClassFactory and CComPooledObject
+
+#pragma once
+
+// A class T uses the pooled class factory with DECLARE_CLASSFACTORY_EX(CPooledClassFactory<T>).
+// The factory creates the objects as CComPooledObject<T>: when the last reference to an object is
+// released, the object isn't destroyed, but kept in a pool for the next CreateInstance(). So the
+// hot path of the activation allocates nothing, and FinalConstruct() runs only once per object.
+// Instead, T provides hooks in the style of IObjectControl of COM+:
+// - HRESULT Activate(): prepares the object for a new client (new or taken from the pool),
+// - void Deactivate(): resets the object after its last reference was released,
+// - bool CanBePooled() const: returns false, if the object must be destroyed instead.
+// The factory itself is created once (by the object map of the module) and is cached as long as
+// the DLL is loaded. Aggregated objects can't be pooled, they're created as by CComClassFactory.
+// The pool of a class is process-wide, so an object released in one apartment is handed to a
+// client in another one: only classes, which may be called from any apartment (i.e. aggregate the
+// free threaded marshaler and hold no apartment bound pointers) may be pooled.
+// The pooled objects are destroyed by DrainPool(), which the DLL calls from DllCanUnloadNow()
+// before it's unloaded. Not from a static destructor: that runs in DllMain() under the loader
+// lock, where FinalRelease() mustn't call into other DLLs (e.g. release the free threaded
+// marshaler). The objects still pooled when the process exits are left to the OS.
+
+
+// The count of released objects a pool keeps for reuse.
+const LONG ObjectPoolCapacity(32);
+
+
+// CComObjectPool
+// Keeps released objects of type T for reuse, until they're destroyed by Drain().
+
+template <class T>
+class CComObjectPool
+{
+public:
+	CComObjectPool()
+		: m_count(0)
+	{
+	}
+
+	// Returns a kept object, or NULL, if the pool is empty.
+	T* Pop()
+	{
+		CComCritSecLock<CComGlobalsThreadModel::AutoCriticalSection> lock(m_lock);
+		return 0 < m_count ? m_objects[--m_count] : NULL;
+	}
+
+	// Keeps object, returns false, if the pool is full.
+	bool Push(T* object)
+	{
+		CComCritSecLock<CComGlobalsThreadModel::AutoCriticalSection> lock(m_lock);
+		if (ObjectPoolCapacity == m_count)
+		{
+			return false;
+		}
+		m_objects[m_count++] = object;
+		return true;
+	}
+
+	// Destroys the kept objects. The objects are deleted outside of the lock, as their
+	// FinalRelease() may call into other DLLs.
+	void Drain()
+	{
+		for (T* object(Pop()); object; object = Pop())
+		{
+			delete object;
+		}
+	}
+
+private:
+	CComObjectPool(const CComObjectPool&);
+	CComObjectPool& operator=(const CComObjectPool&);
+
+	CComGlobalsThreadModel::AutoCriticalSection m_lock;
+	T* m_objects[ObjectPoolCapacity];
+	LONG m_count;
+};
+
+
+// CComPooledObject
+// Implements IUnknown for Base like CComObject, but puts the object into the pool of Base, when
+// its last reference is released. An object holds a lock of the module only while it has
+// references, so the objects in the pool don't keep the DLL loaded.
+
+template <class Base>
+class CComPooledObject : public Base
+{
+public:
+	typedef Base _BaseClass;
+
+	virtual ~CComPooledObject()
+	{
+		this->m_dwRef = -(LONG_MAX / 2);
+		this->FinalRelease();
+	}
+
+	// Creates an object or takes one from the pool, and queries it for riid.
+	static HRESULT WINAPI CreateInstance(REFIID riid, void** ppv)
+	{
+		*ppv = NULL;
+		CComPooledObject<Base>* object(s_pool.Pop());
+		HRESULT hr = S_OK;
+		if (!object)
+		{
+			// Constructed as by CComCreator.
+			ATLTRY(object = new CComPooledObject<Base>())
+			if (!object)
+			{
+				return E_OUTOFMEMORY;
+			}
+			object->SetVoid(NULL);
+			object->InternalFinalConstructAddRef();
+			hr = object->_AtlInitialConstruct();
+			if (SUCCEEDED(hr))
+			{
+				hr = object->FinalConstruct();
+			}
+			if (SUCCEEDED(hr))
+			{
+				hr = object->_AtlFinalConstruct();
+			}
+			object->InternalFinalConstructRelease();
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = object->Activate();
+		}
+		if (FAILED(hr))
+		{
+			delete object;
+			return hr;
+		}
+
+		_pAtlModule->Lock();
+		hr = object->QueryInterface(riid, ppv);
+		if (FAILED(hr))
+		{
+			object->Recycle();
+		}
+		return hr;
+	}
+
+	// Destroys the objects in the pool of Base, see DllCanUnloadNow().
+	static void DrainPool()
+	{
+		s_pool.Drain();
+	}
+
+	STDMETHOD_(ULONG, AddRef)()
+	{
+		return this->InternalAddRef();
+	}
+
+	STDMETHOD_(ULONG, Release)()
+	{
+		const ULONG count(this->InternalRelease());
+		if (0 == count)
+		{
+			Recycle();
+		}
+		return count;
+	}
+
+	STDMETHOD(QueryInterface)(REFIID iid, void** ppvObject)
+	{
+		return this->_InternalQueryInterface(iid, ppvObject);
+	}
+
+private:
+	// Resets the object, which has no references anymore, and puts it into the pool (or destroys
+	// it), then releases its lock of the module.
+	void Recycle()
+	{
+		this->Deactivate();
+		if (!this->CanBePooled() || !s_pool.Push(this))
+		{
+			delete this;
+		}
+		_pAtlModule->Unlock();
+	}
+
+	static CComObjectPool<CComPooledObject<Base> > s_pool;
+};
+
+template <class Base>
+CComObjectPool<CComPooledObject<Base> > CComPooledObject<Base>::s_pool;
+
+
+// CPooledClassFactory
+// The class factory of the objects of T, which takes them from the pool of T.
+
+template <class T>
+class CPooledClassFactory : public CComClassFactory
+{
+public:
+	STDMETHOD(CreateInstance)(LPUNKNOWN pUnkOuter, REFIID riid, void** ppvObj)
+	{
+		if (!ppvObj)
+		{
+			return E_POINTER;
+		}
+		if (pUnkOuter)
+		{
+			return CComClassFactory::CreateInstance(pUnkOuter, riid, ppvObj);
+		}
+		return CComPooledObject<T>::CreateInstance(riid, ppvObj);
+	}
+};
@@ -0,0 +1,240 @@
+// ServerStats.cpp : Implementation of the instrumentation of AComServer
+
+#include "stdafx.h"
+#include "resource.h"
+#include "ServerStats.h"
+#include "dllmain.h"
+
+
+namespace
+{
+	LPCOLESTR const methodNames[StatsMethodCount] =
+	{
+		L"GetData",
+		L"GetDataBatch",
+		L"CopyData",
+		L"GetDataSection",
+		L"IEnumString::Next",
+		L"GetIDsOfNames",
+		L"Invoke",
+		L"AsyncINicosDataSource::GetData"
+	};
+
+	// The counters, only changed with interlocked operations.
+	volatile LONGLONG calls[StatsMethodCount];
+	volatile LONGLONG nanoseconds[StatsMethodCount];
+	volatile LONGLONG bytes[StatsMethodCount];
+	volatile LONGLONG histograms[StatsMethodCount][StatsHistogramBuckets];
+	volatile LONGLONG activations;
+
+	LONGLONG QueryTicksPerSecond()
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return frequency.QuadPart;
+	}
+
+	// Initialized when the DLL is loaded.
+	const LONGLONG ticksPerSecond(QueryTicksPerSecond());
+
+	void ResetCounter(volatile LONGLONG& counter)
+	{
+		InterlockedExchange64(&counter, 0);
+	}
+}
+
+
+volatile LONG CServerStats::s_enabled(0);
+
+
+void CServerStats::Enable(bool enable)
+{
+	InterlockedExchange(&s_enabled, enable ? 1 : 0);
+}
+
+
+LONGLONG CServerStats::Now()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+
+void CServerStats::RecordCall(StatsMethod method, LONGLONG start, ULONGLONG returnedBytes)
+{
+	const ULONGLONG ticks(static_cast<ULONGLONG>(Now() - start));
+	const ULONGLONG frequency(static_cast<ULONGLONG>(ticksPerSecond));
+	// Split, so that the multiplication doesn't overflow.
+	const ULONGLONG elapsed(ticks / frequency * 1000000000
+		+ ticks % frequency * 1000000000 / frequency);
+
+	ULONG bucket(0);
+	DWORD highestBit(0);
+	if (_BitScanReverse(&highestBit, elapsed < ULONG_MAX ? static_cast<ULONG>(elapsed) : ULONG_MAX))
+	{
+		bucket = highestBit + 1 < StatsHistogramBuckets
+			? highestBit + 1
+			: StatsHistogramBuckets - 1;
+	}
+
+	InterlockedIncrement64(&calls[method]);
+	InterlockedExchangeAdd64(&nanoseconds[method], static_cast<LONGLONG>(elapsed));
+	InterlockedExchangeAdd64(&bytes[method], static_cast<LONGLONG>(returnedBytes));
+	InterlockedIncrement64(&histograms[method][bucket]);
+}
+
+
+void CServerStats::RecordActivation()
+{
+	if (IsEnabled())
+	{
+		InterlockedIncrement64(&activations);
+	}
+}
+
+
+// Resets each counter on its own, the counters of calls, which are recorded meanwhile, may not
+// match.
+void CServerStats::Reset()
+{
+	for (int method(0); method < StatsMethodCount; ++method)
+	{
+		ResetCounter(calls[method]);
+		ResetCounter(nanoseconds[method]);
+		ResetCounter(bytes[method]);
+		for (ULONG bucket(0); bucket < StatsHistogramBuckets; ++bucket)
+		{
+			ResetCounter(histograms[method][bucket]);
+		}
+	}
+	ResetCounter(activations);
+}
+
+
+LPCOLESTR CServerStats::MethodName(StatsMethod method)
+{
+	return methodNames[method];
+}
+
+
+// Reads the counters with an interlocked operation, so that a 64-bit counter isn't read torn on a
+// 32-bit CPU.
+LONGLONG CServerStats::Calls(StatsMethod method)
+{
+	return InterlockedCompareExchange64(&calls[method], 0, 0);
+}
+
+
+LONGLONG CServerStats::Nanoseconds(StatsMethod method)
+{
+	return InterlockedCompareExchange64(&nanoseconds[method], 0, 0);
+}
+
+
+LONGLONG CServerStats::Bytes(StatsMethod method)
+{
+	return InterlockedCompareExchange64(&bytes[method], 0, 0);
+}
+
+
+LONGLONG CServerStats::HistogramBucket(StatsMethod method, ULONG bucket)
+{
+	return InterlockedCompareExchange64(&histograms[method][bucket], 0, 0);
+}
+
+
+LONGLONG CServerStats::Activations()
+{
+	return InterlockedCompareExchange64(&activations, 0, 0);
+}
+
+
+// IAComServerStatsImpl
+
+
+
+STDMETHODIMP IAComServerStatsImpl::IsEnabled(BOOL* enabled)
+{
+	if (!enabled)
+	{
+		return E_POINTER;
+	}
+	*enabled = CServerStats::IsEnabled() ? TRUE : FALSE;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP IAComServerStatsImpl::Enable(BOOL enable)
+{
+	CServerStats::Enable(FALSE != enable);
+
+	return S_OK;
+}
+
+
+STDMETHODIMP IAComServerStatsImpl::GetMethodCount(ULONG* count)
+{
+	if (!count)
+	{
+		return E_POINTER;
+	}
+	*count = StatsMethodCount;
+
+	return S_OK;
+}
+
+
+// Returns the counters of the method with the index method (up to GetMethodCount()), and the
+// first bucketCount buckets of its latency histogram.
+STDMETHODIMP IAComServerStatsImpl::GetMethodStats(ULONG method, BSTR* name, LONGLONG* calls,
+	LONGLONG* nanoseconds, LONGLONG* bytes, ULONG bucketCount, LONGLONG* histogram)
+{
+	if (!name || !calls || !nanoseconds || !bytes || (!histogram && 0 != bucketCount))
+	{
+		return E_POINTER;
+	}
+	*name = NULL;
+	if (StatsMethodCount <= method)
+	{
+		return E_INVALIDARG;
+	}
+
+	const StatsMethod statsMethod(static_cast<StatsMethod>(method));
+	*calls = CServerStats::Calls(statsMethod);
+	*nanoseconds = CServerStats::Nanoseconds(statsMethod);
+	*bytes = CServerStats::Bytes(statsMethod);
+	for (ULONG bucket(0); bucket < bucketCount; ++bucket)
+	{
+		histogram[bucket] = bucket < StatsHistogramBuckets
+			? CServerStats::HistogramBucket(statsMethod, bucket)
+			: 0;
+	}
+	*name = SysAllocString(CServerStats::MethodName(statsMethod));
+
+	return *name ? S_OK : E_OUTOFMEMORY;
+}
+
+
+// The live objects are the locks of the module: each object holds one while it has references
+// (a client holding a lock with IClassFactory::LockServer() is counted as well).
+STDMETHODIMP IAComServerStatsImpl::GetObjectStats(LONG* liveObjects, LONGLONG* activations)
+{
+	if (!liveObjects || !activations)
+	{
+		return E_POINTER;
+	}
+	*liveObjects = _AtlModule.GetLockCount();
+	*activations = CServerStats::Activations();
+
+	return S_OK;
+}
+
+
+STDMETHODIMP IAComServerStatsImpl::Reset()
+{
+	CServerStats::Reset();
+
+	return S_OK;
+}
@@ -0,0 +1,121 @@
+// ServerStats.h : Declaration of the instrumentation of AComServer
+
+#pragma once
+#include "AComServer_i.h"
+
+// The counters of AComServer: the calls, their latencies and the bytes returned per method, the
+// activations of the objects and (from the lock count of the module) the live objects. The
+// counters are updated with interlocked operations, without locks. They are disabled by default:
+// then an instrumented call only reads a flag, it doesn't even read the clock. A client enables
+// the counters and reads them through IAComServerStats, which every CNicosComClass implements.
+
+
+// The instrumented methods.
+enum StatsMethod
+{
+	StatsGetData,
+	StatsGetDataBatch,
+	StatsCopyData,
+	StatsGetDataSection,
+	StatsEnumNext,
+	StatsGetIDsOfNames,
+	// Includes the method it calls.
+	StatsInvoke,
+	// From Begin_GetData() to the completion of the call.
+	StatsAsyncGetData,
+	StatsMethodCount
+};
+
+
+// The count of buckets of a latency histogram. Bucket 0 counts the calls, which took less than 1
+// nanosecond, bucket i the calls, which took 2^(i-1) up to 2^i nanoseconds, and the last bucket
+// all longer calls.
+const ULONG StatsHistogramBuckets(32);
+
+
+// The counters of the module.
+class CServerStats
+{
+public:
+	static bool IsEnabled()
+	{
+		return 0 != s_enabled;
+	}
+
+	static void Enable(bool enable);
+
+	// Returns the ticks of the performance counter.
+	static LONGLONG Now();
+
+	// Counts a call of method, which started at start (in ticks of Now()) and returned bytes.
+	static void RecordCall(StatsMethod method, LONGLONG start, ULONGLONG bytes);
+
+	static void RecordActivation();
+
+	static void Reset();
+
+	static LPCOLESTR MethodName(StatsMethod method);
+
+	static LONGLONG Calls(StatsMethod method);
+
+	static LONGLONG Nanoseconds(StatsMethod method);
+
+	static LONGLONG Bytes(StatsMethod method);
+
+	static LONGLONG HistogramBucket(StatsMethod method, ULONG bucket);
+
+	static LONGLONG Activations();
+
+private:
+	static volatile LONG s_enabled;
+};
+
+
+// Measures a call from its construction to its destruction, if the counters are enabled.
+class CStatsCall
+{
+public:
+	explicit CStatsCall(StatsMethod method)
+		: m_method(method), m_start(CServerStats::IsEnabled() ? CServerStats::Now() : 0),
+		m_bytes(0)
+	{
+	}
+
+	~CStatsCall()
+	{
+		if (0 != m_start)
+		{
+			CServerStats::RecordCall(m_method, m_start, m_bytes);
+		}
+	}
+
+	// Counts bytes as returned by the call.
+	void AddBytes(ULONGLONG bytes)
+	{
+		m_bytes += bytes;
+	}
+
+private:
+	CStatsCall(const CStatsCall&);
+	CStatsCall& operator=(const CStatsCall&);
+
+	const StatsMethod m_method;
+	const LONGLONG m_start;
+	ULONGLONG m_bytes;
+};
+
+
+// IAComServerStatsImpl
+// Implements IAComServerStats on the counters of the module.
+
+class ATL_NO_VTABLE IAComServerStatsImpl : public IAComServerStats
+{
+public:
+	STDMETHOD(IsEnabled)(BOOL* enabled);
+	STDMETHOD(Enable)(BOOL enable);
+	STDMETHOD(GetMethodCount)(ULONG* count);
+	STDMETHOD(GetMethodStats)(ULONG method, BSTR* name, LONGLONG* calls, LONGLONG* nanoseconds,
+		LONGLONG* bytes, ULONG bucketCount, LONGLONG* histogram);
+	STDMETHOD(GetObjectStats)(LONG* liveObjects, LONGLONG* activations);
+	STDMETHOD(Reset)();
+};
@@ -10,7 +10,15 @@
 
 #include "targetver.h"
 
+// ACOMSERVER_FREE_THREADED (defined by the configurations "Debug FreeThreaded" and "Release
+// FreeThreaded") builds the server for the threading model 'Both': the objects are thread-safe
+// and aggregate the free threaded marshaler, so callers in an MTA (e.g. a thread pool) call them
+// directly instead of through a proxy into a single STA.
+#ifdef ACOMSERVER_FREE_THREADED
+#define _ATL_FREE_THREADED
+#else
 #define _ATL_APARTMENT_THREADED
+#endif
 
 #define _ATL_NO_AUTOMATIC_NAMESPACE
 
@@ -23,3 +31,4 @@
 #include <atlbase.h>
 #include <atlcom.h>
 #include <atlctl.h>
+#include <atlfile.h>
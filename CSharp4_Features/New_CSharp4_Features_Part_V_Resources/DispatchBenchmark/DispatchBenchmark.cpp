@@ -0,0 +1,400 @@
+// DispatchBenchmark.cpp : Measures the costs of the bindings of a call from C++.
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define NOMINMAX
+#include <windows.h>
+#include <oleauto.h>
+
+#include "AComServer_i.h"
+#include "InlineCache.h"
+
+// This benchmark measures the same operation - get the data (a BSTR) and its size - through the
+// bindings a C++ client can choose from, from the earliest to the latest binding:
+// - template: a call to a template parameter (static typing, see TemplateTyping), which can be
+//   inlined,
+// - virtual: a virtual call through a pointer to an abstract base class,
+// - comVtable: a call of INicosComClass::GetData() through the vtable of the COM interface (the
+//   COM server AComServer.dll must be registered),
+// - comNativeBuffer: a call of INicosComClassNative::CopyData(), which copies the data into a
+//   buffer of the caller (no BSTR is allocated),
+// - dispatchInvoke: a late bound call with IDispatch::Invoke(), the DISPID is looked up once,
+// - dispatchByName: a late bound call, which looks up the DISPID by name on each call (as a
+//   script engine without caching does),
+// - dispatchCachedByName: a late bound call by name, which looks up the DISPID through the
+//   inline cache of its call site (see InlineCache.h), so the name is resolved once per object,
+// - typeInfoInvoke, typeInfoByName: the same late bound calls through the type information
+//   (ITypeInfo::Invoke() and ITypeInfo::GetIDsOfNames()), the way IDispatchImpl implements
+//   IDispatch. CNicosComClass implements both methods itself with a hash table and a switch, so
+//   dispatchInvoke and dispatchByName compare to them like after to before.
+// The C# bindings (incl. dynamic) are measured by DispatchBenchmarkCSharp with the same output.
+// The calls are timed in samples of SampleCalls calls, because a single call is shorter than the
+// resolution of the timer. The latencies are the average durations of a call in each sample,
+// reported as percentiles over all samples. The results are written as JSON to stdout:
+//   DispatchBenchmark.exe [calls=1000000] > results.json
+// This thread is an STA, so the COM calls are direct calls into the in-process server (no proxy)
+// in both the apartment threaded and the free threaded build of the server.
+
+
+// The count of calls timed together.
+const int SampleCalls(64);
+
+
+// The data of the native variants, the same as the COM server's.
+const wchar_t* const NativeData(L"Hello World!");
+
+
+// The interface of the virtual variant.
+class IDataSource
+{
+public:
+	virtual ~IDataSource()
+	{
+	}
+
+	virtual HRESULT GetData(BSTR* data) = 0;
+};
+
+
+// The implementation of the template and the virtual variant.
+class NativeDataSource : public IDataSource
+{
+public:
+	HRESULT GetData(BSTR* data)
+	{
+		*data = SysAllocString(NativeData);
+		return *data ? S_OK : E_OUTOFMEMORY;
+	}
+};
+
+
+// Returns the data source of the virtual variant, out of sight of the optimizer, so that the call
+// isn't devirtualized.
+__declspec(noinline) IDataSource* createDataSource()
+{
+	return new NativeDataSource();
+}
+
+
+// Gets the data of t by calling its method GetData() (with whatever binding T provides), frees it
+// and returns its size.
+template <typename T> UINT getDataSize(T& t)
+{
+	BSTR data(0);
+	if (FAILED(t.GetData(&data)))
+	{
+		return 0;
+	}
+	const UINT size(SysStringLen(data));
+	SysFreeString(data);
+	return size;
+}
+
+
+// Copies the data of the native interface into a buffer on the stack and returns its size.
+UINT getDataSize(INicosComClassNative& source)
+{
+	OLECHAR buffer[64];
+	ULONG length(0);
+	return SUCCEEDED(source.CopyData(_countof(buffer), buffer, &length)) ? length : 0;
+}
+
+
+// Calls GetData() on an IDispatch with the passed DISPID.
+class DispatchDataSource
+{
+public:
+	DispatchDataSource(IDispatch* dispatch, DISPID dispId)
+		: dispatch_(dispatch), dispId_(dispId)
+	{
+	}
+
+	HRESULT GetData(BSTR* data)
+	{
+		DISPPARAMS noArguments = {0, 0, 0, 0};
+		VARIANT result;
+		VariantInit(&result);
+		const HRESULT hr(dispatch_->Invoke(dispId_, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_METHOD,
+			&noArguments, &result, 0, 0));
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+		if (VT_BSTR != result.vt)
+		{
+			VariantClear(&result);
+			return DISP_E_TYPEMISMATCH;
+		}
+		*data = result.bstrVal;
+		return S_OK;
+	}
+
+protected:
+	IDispatch* dispatch_;
+	DISPID dispId_;
+};
+
+
+// Looks up the DISPID of GetData() by name on each call, then calls it with IDispatch::Invoke().
+class DispatchByNameDataSource : public DispatchDataSource
+{
+public:
+	explicit DispatchByNameDataSource(IDispatch* dispatch)
+		: DispatchDataSource(dispatch, DISPID_UNKNOWN)
+	{
+	}
+
+	HRESULT GetData(BSTR* data)
+	{
+		LPOLESTR name(const_cast<LPOLESTR>(L"GetData"));
+		const HRESULT hr(dispatch_->GetIDsOfNames(IID_NULL, &name, 1, LOCALE_USER_DEFAULT,
+			&dispId_));
+		return FAILED(hr) ? hr : DispatchDataSource::GetData(data);
+	}
+};
+
+
+// Looks up the DISPID of GetData() by name on each call, but through an inline cache, which
+// calls GetIDsOfNames() only on a miss. The cache is keyed by the IDispatch, which must outlive
+// the data source.
+class DispatchCachedByNameDataSource : public DispatchDataSource
+{
+	struct NameResolver
+	{
+		bool operator()(IDispatch* dispatch, DISPID& dispId) const
+		{
+			LPOLESTR name(const_cast<LPOLESTR>(L"GetData"));
+			return SUCCEEDED(dispatch->GetIDsOfNames(IID_NULL, &name, 1, LOCALE_USER_DEFAULT,
+				&dispId));
+		}
+	};
+
+public:
+	explicit DispatchCachedByNameDataSource(IDispatch* dispatch)
+		: DispatchDataSource(dispatch, DISPID_UNKNOWN)
+	{
+	}
+
+	HRESULT GetData(BSTR* data)
+	{
+		if (!cache_.lookup(dispatch_, dispId_, NameResolver()))
+		{
+			return DISP_E_UNKNOWNNAME;
+		}
+		return DispatchDataSource::GetData(data);
+	}
+
+private:
+	InlineCache<IDispatch*, DISPID> cache_;
+};
+
+
+// Calls GetData() through the type information of INicosComClass, as IDispatchImpl does.
+class TypeInfoDataSource
+{
+public:
+	TypeInfoDataSource(ITypeInfo* typeInfo, INicosComClass* comObject, bool byName)
+		: typeInfo_(typeInfo), comObject_(comObject), byName_(byName), dispId_(DISPID_UNKNOWN)
+	{
+		LPOLESTR name(const_cast<LPOLESTR>(L"GetData"));
+		typeInfo_->GetIDsOfNames(&name, 1, &dispId_);
+	}
+
+	HRESULT GetData(BSTR* data)
+	{
+		if (byName_)
+		{
+			LPOLESTR name(const_cast<LPOLESTR>(L"GetData"));
+			const HRESULT hr(typeInfo_->GetIDsOfNames(&name, 1, &dispId_));
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+		}
+		DISPPARAMS noArguments = {0, 0, 0, 0};
+		VARIANT result;
+		VariantInit(&result);
+		const HRESULT hr(typeInfo_->Invoke(comObject_, dispId_, DISPATCH_METHOD, &noArguments,
+			&result, 0, 0));
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+		if (VT_BSTR != result.vt)
+		{
+			VariantClear(&result);
+			return DISP_E_TYPEMISMATCH;
+		}
+		*data = result.bstrVal;
+		return S_OK;
+	}
+
+private:
+	ITypeInfo* typeInfo_;
+	INicosComClass* comObject_;
+	bool byName_;
+	DISPID dispId_;
+};
+
+
+// Returns the ticks of the performance counter.
+LONGLONG ticks()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+
+// Returns the value at the passed fraction of the sorted values.
+double percentile(const std::vector<double>& sortedValues, double fraction)
+{
+	const std::size_t index(static_cast<std::size_t>(fraction * (sortedValues.size() - 1) + 0.5));
+	return sortedValues[index];
+}
+
+
+// Calls getDataSize(source) calls times in samples and writes calls per second and the latencies
+// as JSON object.
+template <typename T> void benchmark(const char* binding, T& source, int calls, bool first)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	const double nanosecondsPerTick(1e9 / static_cast<double>(frequency.QuadPart));
+
+	// Warm up (e.g. load the type library of the IDispatch implementation).
+	UINT totalSize(getDataSize(source));
+
+	const int samples(std::max(1, calls / SampleCalls));
+	std::vector<double> latencies;
+	latencies.reserve(samples);
+	LONGLONG totalTicks(0);
+	for (int sample(0); sample < samples; ++sample)
+	{
+		const LONGLONG start(ticks());
+		for (int call(0); call < SampleCalls; ++call)
+		{
+			totalSize += getDataSize(source);
+		}
+		const LONGLONG sampleTicks(ticks() - start);
+		totalTicks += sampleTicks;
+		latencies.push_back(sampleTicks * nanosecondsPerTick / SampleCalls);
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	const double totalCalls(static_cast<double>(samples) * SampleCalls);
+	const double seconds(totalTicks * nanosecondsPerTick / 1e9);
+	std::printf("%s    {\"binding\": \"%s\", \"operation\": \"GetData\", \"calls\": %.0f, "
+		"\"callsPerSecond\": %.1f, \"latencyNanoseconds\": {\"p50\": %.1f, \"p90\": %.1f, "
+		"\"p99\": %.1f, \"max\": %.1f}, \"checksum\": %u}", first ? "" : ",\n", binding,
+		totalCalls, 0 < seconds ? totalCalls / seconds : 0.0, percentile(latencies, 0.5),
+		percentile(latencies, 0.9), percentile(latencies, 0.99), latencies.back(), totalSize);
+	std::fflush(stdout);
+}
+
+
+// Writes the failure of a binding as JSON object.
+void failed(const char* binding, HRESULT hr)
+{
+	std::printf(",\n    {\"binding\": \"%s\", \"operation\": \"GetData\", "
+		"\"error\": \"HRESULT 0x%08lX\"}", binding, static_cast<unsigned long>(hr));
+}
+
+
+int _tmain(int argc, _TCHAR* argv[])
+{
+	const int calls(std::max(SampleCalls, 1 < argc ? _ttoi(argv[1]) : 1000000));
+
+	std::printf("{\n  \"benchmark\": \"Dispatch\",\n  \"language\": \"C++\",\n"
+		"  \"results\": [\n");
+
+	NativeDataSource nativeSource;
+	benchmark("template", nativeSource, calls, true);
+
+	IDataSource* const virtualSource(createDataSource());
+	benchmark("virtual", *virtualSource, calls, false);
+	delete virtualSource;
+
+	const HRESULT initialized(CoInitializeEx(0, COINIT_APARTMENTTHREADED));
+	INicosComClass* comObject(0);
+	HRESULT hr(FAILED(initialized)
+		? initialized
+		: CoCreateInstance(__uuidof(NicosComClass), 0, CLSCTX_INPROC_SERVER,
+			__uuidof(INicosComClass), reinterpret_cast<void**>(&comObject)));
+	if (SUCCEEDED(hr))
+	{
+		benchmark("comVtable", *comObject, calls, false);
+
+		INicosComClassNative* nativeObject(0);
+		hr = comObject->QueryInterface(__uuidof(INicosComClassNative),
+			reinterpret_cast<void**>(&nativeObject));
+		if (SUCCEEDED(hr))
+		{
+			benchmark("comNativeBuffer", *nativeObject, calls, false);
+			nativeObject->Release();
+		}
+		else
+		{
+			failed("comNativeBuffer", hr);
+		}
+
+		LPOLESTR name(const_cast<LPOLESTR>(L"GetData"));
+		DISPID dispId(DISPID_UNKNOWN);
+		hr = comObject->GetIDsOfNames(IID_NULL, &name, 1, LOCALE_USER_DEFAULT, &dispId);
+		if (SUCCEEDED(hr))
+		{
+			DispatchDataSource dispatchSource(comObject, dispId);
+			benchmark("dispatchInvoke", dispatchSource, calls, false);
+			DispatchByNameDataSource dispatchByNameSource(comObject);
+			benchmark("dispatchByName", dispatchByNameSource, calls, false);
+			DispatchCachedByNameDataSource dispatchCachedByNameSource(comObject);
+			benchmark("dispatchCachedByName", dispatchCachedByNameSource, calls, false);
+		}
+		else
+		{
+			failed("dispatchInvoke", hr);
+			failed("dispatchByName", hr);
+			failed("dispatchCachedByName", hr);
+		}
+
+		ITypeInfo* typeInfo(0);
+		hr = comObject->GetTypeInfo(0, LOCALE_USER_DEFAULT, &typeInfo);
+		if (SUCCEEDED(hr))
+		{
+			TypeInfoDataSource typeInfoSource(typeInfo, comObject, false);
+			benchmark("typeInfoInvoke", typeInfoSource, calls, false);
+			TypeInfoDataSource typeInfoByNameSource(typeInfo, comObject, true);
+			benchmark("typeInfoByName", typeInfoByNameSource, calls, false);
+			typeInfo->Release();
+		}
+		else
+		{
+			failed("typeInfoInvoke", hr);
+			failed("typeInfoByName", hr);
+		}
+		comObject->Release();
+	}
+	else
+	{
+		// E.g. REGDB_E_CLASSNOTREG, if AComServer.dll isn't registered.
+		failed("comVtable", hr);
+		failed("comNativeBuffer", hr);
+		failed("dispatchInvoke", hr);
+		failed("dispatchByName", hr);
+		failed("dispatchCachedByName", hr);
+		failed("typeInfoInvoke", hr);
+		failed("typeInfoByName", hr);
+	}
+	if (SUCCEEDED(initialized))
+	{
+		CoUninitialize();
+	}
+
+	std::printf("\n  ]\n}\n");
+	return EXIT_SUCCESS;
+}
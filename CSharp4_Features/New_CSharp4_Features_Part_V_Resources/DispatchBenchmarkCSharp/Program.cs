@@ -0,0 +1,160 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Reflection;
+using System.Runtime.InteropServices;
+
+
+// This benchmark measures the same operation - get the data (a string) and its size - through the
+// bindings a C# client can choose from, from the earliest to the latest binding:
+// - staticCall: a call of a method of a sealed class (which can be inlined by the JIT),
+// - interfaceCall: a call through an interface,
+// - dynamicClr: a call on a dynamic variable referring to a CLR object (the DLR binds the call on
+//   the first call, and caches the binding in the call site),
+// - comDynamic: a call on a dynamic variable referring to the COM object NicosComClass (the DLR's
+//   COM binder calls IDispatch::Invoke(), the COM server AComServer.dll must be registered),
+// - comInvokeMember: a late bound call with Type.InvokeMember() on the COM object (the binding
+//   before C#4's dynamic).
+// The C++ bindings (incl. templates and IDispatch::Invoke()) are measured by DispatchBenchmark
+// with the same output. The calls are timed in samples of SampleCalls calls, because a single call
+// is shorter than the resolution of the timer. The latencies are the average durations of a call
+// in each sample, reported as percentiles over all samples. The results are written as JSON to
+// the console:
+//   DispatchBenchmarkCSharp.exe [calls=1000000] > results.json
+namespace DispatchBenchmarkCSharp
+{
+    // The interface of the interfaceCall variant.
+    public interface IDataSource
+    {
+        string GetData();
+    }
+
+
+    // The implementation of the CLR variants, it returns the same data as the COM server.
+    public sealed class DataSource : IDataSource
+    {
+        private static readonly char[] Data = "Hello World!".ToCharArray();
+
+        // A new string on each call, as the COM server allocates a new BSTR on each call.
+        public string GetData()
+        {
+            return new string(Data);
+        }
+    }
+
+
+    public class Program
+    {
+        // The count of calls timed together.
+        private const int SampleCalls = 64;
+
+
+        // Calls getDataSize() calls times in samples and writes calls per second and the
+        // latencies as JSON object.
+        private static void Benchmark(string binding, Func<int> getDataSize, int calls, bool first)
+        {
+            double nanosecondsPerTick = 1e9 / Stopwatch.Frequency;
+
+            // Warm up (e.g. let the JIT compile and the DLR bind the call).
+            long totalSize = getDataSize();
+
+            int samples = Math.Max(1, calls / SampleCalls);
+            List<double> latencies = new List<double>(samples);
+            long totalTicks = 0;
+            for (int sample = 0; sample < samples; ++sample)
+            {
+                long start = Stopwatch.GetTimestamp();
+                for (int call = 0; call < SampleCalls; ++call)
+                {
+                    totalSize += getDataSize();
+                }
+                long sampleTicks = Stopwatch.GetTimestamp() - start;
+                totalTicks += sampleTicks;
+                latencies.Add(sampleTicks * nanosecondsPerTick / SampleCalls);
+            }
+            latencies.Sort();
+
+            double totalCalls = (double)samples * SampleCalls;
+            double seconds = totalTicks * nanosecondsPerTick / 1e9;
+            Console.Write(string.Format(CultureInfo.InvariantCulture,
+                "{0}    {{\"binding\": \"{1}\", \"operation\": \"GetData\", \"calls\": {2:0}, "
+                + "\"callsPerSecond\": {3:0.0}, \"latencyNanoseconds\": {{\"p50\": {4:0.0}, "
+                + "\"p90\": {5:0.0}, \"p99\": {6:0.0}, \"max\": {7:0.0}}}, \"checksum\": {8}}}",
+                first ? "" : ",\n", binding, totalCalls, 0 < seconds ? totalCalls / seconds : 0.0,
+                Percentile(latencies, 0.5), Percentile(latencies, 0.9),
+                Percentile(latencies, 0.99), latencies[latencies.Count - 1], totalSize));
+        }
+
+
+        // Returns the value at the passed fraction of the sorted values.
+        private static double Percentile(List<double> sortedValues, double fraction)
+        {
+            return sortedValues[(int)(fraction * (sortedValues.Count - 1) + 0.5)];
+        }
+
+
+        // Writes the failure of a binding as JSON object.
+        private static void Failed(string binding, string error)
+        {
+            Console.Write(",\n    {{\"binding\": \"{0}\", \"operation\": \"GetData\", "
+                + "\"error\": \"{1}\"}}", binding, error.Replace("\"", "'"));
+        }
+
+
+        // The main thread is an STA like the thread of DispatchBenchmark, so the apartment threaded
+        // NicosComClass is created in this apartment, and the COM calls are direct calls into the
+        // in-process server instead of calls through a proxy into a host STA.
+        [STAThread]
+        public static void Main(string[] args)
+        {
+            int calls = Math.Max(SampleCalls, 0 < args.Length ? int.Parse(args[0]) : 1000000);
+
+            Console.Write("{\n  \"benchmark\": \"Dispatch\",\n  \"language\": \"C#\",\n"
+                + "  \"results\": [\n");
+
+            DataSource staticSource = new DataSource();
+            Benchmark("staticCall", () => staticSource.GetData().Length, calls, true);
+
+            IDataSource interfaceSource = new DataSource();
+            Benchmark("interfaceCall", () => interfaceSource.GetData().Length, calls, false);
+
+            dynamic dynamicSource = new DataSource();
+            Benchmark("dynamicClr",
+                () => { string data = dynamicSource.GetData(); return data.Length; },
+                calls, false);
+
+            Type comType = Type.GetTypeFromProgID("NicosComClass");
+            object comObject = null;
+            try
+            {
+                comObject = null != comType ? Activator.CreateInstance(comType) : null;
+            }
+            catch (COMException exception)
+            {
+                Failed("comDynamic", exception.Message);
+                Failed("comInvokeMember", exception.Message);
+            }
+            if (null != comObject)
+            {
+                dynamic dynamicComObject = comObject;
+                Benchmark("comDynamic",
+                    () => { string data = dynamicComObject.GetData(); return data.Length; },
+                    calls, false);
+                Benchmark("comInvokeMember",
+                    () => ((string)comType.InvokeMember("GetData", BindingFlags.InvokeMethod,
+                        null, comObject, null)).Length,
+                    calls, false);
+                Marshal.ReleaseComObject(comObject);
+            }
+            else if (null == comType)
+            {
+                // Possibly AComServer.dll (available in this solution) isn't registered.
+                Failed("comDynamic", "NicosComClass is not registered");
+                Failed("comInvokeMember", "NicosComClass is not registered");
+            }
+
+            Console.Write("\n  ]\n}\n");
+        }
+    }
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "ParallelSubsets.h"
+#include "SubsetRange.h"
+
+// This header provides a compact result type for callers, which need all subsets materialized.
+// A std::vector<std::vector<T> > filled by subsets() holds 2^n separate heap blocks (plus the
+// slack of each vector). FlatSubsets instead stores the items of all subsets back to back in one
+// buffer, and the start of each subset in an array of 2^n + 1 offsets. As every item is part of
+// half of the subsets, the buffer's size is known in advance: n * 2^(n - 1) items. Both arrays
+// are carved out of one SubsetArena, i.e. they take a single allocation. An arena can be passed
+// in and reused (after reset()) for further results, otherwise the result uses an own arena.
+// The subsets are stored in the order of subsets(), each one is exposed as SubsetSpan. They can
+// be filled in with multiple threads (see "ParallelSubsets.h"), the result is the same.
+
+
+// A monotonic arena: one block of memory, from which allocations are taken by bumping a pointer.
+// Single allocations can't be freed, reset() releases all of them at once.
+class SubsetArena
+{
+public:
+	explicit SubsetArena(std::size_t capacity)
+		: block_(new char[capacity]), capacity_(capacity), used_(0)
+	{
+	}
+
+	// Returns memory for size bytes aligned to alignment (a power of two), or throws
+	// std::bad_alloc, if the arena is exhausted.
+	void* allocate(std::size_t size, std::size_t alignment)
+	{
+		const std::size_t misalignment(reinterpret_cast<std::size_t>(block_.get() + used_)
+			& (alignment - 1));
+		const std::size_t padding(0 == misalignment ? 0 : alignment - misalignment);
+		if(capacity_ - used_ < padding || capacity_ - used_ - padding < size)
+		{
+			throw std::bad_alloc();
+		}
+		void* const memory(block_.get() + used_ + padding);
+		used_ += padding + size;
+		return memory;
+	}
+
+	// Releases all allocations, the memory of the arena is kept for reuse.
+	void reset()
+	{
+		used_ = 0;
+	}
+
+	std::size_t capacity() const
+	{
+		return capacity_;
+	}
+
+	std::size_t used() const
+	{
+		return used_;
+	}
+
+private:
+	SubsetArena(const SubsetArena&);
+	SubsetArena& operator=(const SubsetArena&);
+
+	std::unique_ptr<char[]> block_;
+	std::size_t capacity_;
+	std::size_t used_;
+};
+
+
+// A subset stored in a FlatSubsets: a view over a contiguous range of items.
+template<typename T>
+class SubsetSpan
+{
+public:
+	typedef const T* iterator;
+	typedef const T* const_iterator;
+	typedef T value_type;
+
+	SubsetSpan(const T* first, const T* last)
+		: first_(first), last_(last)
+	{
+	}
+
+	const T* begin() const
+	{
+		return first_;
+	}
+
+	const T* end() const
+	{
+		return last_;
+	}
+
+	std::size_t size() const
+	{
+		return static_cast<std::size_t>(last_ - first_);
+	}
+
+	bool empty() const
+	{
+		return first_ == last_;
+	}
+
+	const T& operator[](std::size_t index) const
+	{
+		return first_[index];
+	}
+
+private:
+	const T* first_;
+	const T* last_;
+};
+
+
+// All subsets of a sequence of T, stored in one value buffer and one offset array.
+template<typename T>
+class FlatSubsets
+{
+public:
+	typedef SubsetSpan<T> value_type;
+
+	// Materializes the subsets of the sequence from sequenceBegin to sequenceEnd in an own arena,
+	// using threadCount threads (zero means one thread per hardware thread).
+	template<typename RandomAccessIteratorType>
+	FlatSubsets(RandomAccessIteratorType sequenceBegin, RandomAccessIteratorType sequenceEnd,
+		unsigned threadCount = 1)
+		: ownArena_(new SubsetArena(requiredBytes(
+			static_cast<std::size_t>(std::distance(sequenceBegin, sequenceEnd))))),
+			arena_(ownArena_.get())
+	{
+		fill(sequenceBegin, sequenceEnd, threadCount);
+	}
+
+	// Materializes the subsets of the sequence from sequenceBegin to sequenceEnd in the passed
+	// arena, which must outlive the result and must provide requiredBytes() of memory.
+	template<typename RandomAccessIteratorType>
+	FlatSubsets(RandomAccessIteratorType sequenceBegin, RandomAccessIteratorType sequenceEnd,
+		SubsetArena& arena, unsigned threadCount = 1)
+		: arena_(&arena)
+	{
+		fill(sequenceBegin, sequenceEnd, threadCount);
+	}
+
+	~FlatSubsets()
+	{
+		destroyValues(0, valueCount_);
+	}
+
+	// The count of subsets, i.e. 2^n.
+	std::size_t size() const
+	{
+		return subsetCount_;
+	}
+
+	// The count of items of all subsets, i.e. n * 2^(n - 1).
+	std::size_t valueCount() const
+	{
+		return valueCount_;
+	}
+
+	// Returns the subset with the passed index in the order of subsets().
+	SubsetSpan<T> operator[](std::size_t index) const
+	{
+		return SubsetSpan<T>(values_ + offsets_[index], values_ + offsets_[index + 1]);
+	}
+
+	// Returns the bytes an arena must provide for the subsets of itemCount items (including the
+	// padding for the alignment of the items). Throws std::bad_alloc, if this exceeds the address
+	// space.
+	static std::size_t requiredBytes(std::size_t itemCount)
+	{
+		// The count of offsets (times their size) must be far below the limit of std::size_t.
+		if(static_cast<std::size_t>(std::numeric_limits<std::size_t>::digits - 4) <= itemCount)
+		{
+			throw std::bad_alloc();
+		}
+		const unsigned long long subsetCount(1ULL << itemCount);
+		const unsigned long long valueCount(itemCount * (subsetCount / 2));
+		const unsigned long long offsetBytes((subsetCount + 1) * sizeof(std::size_t)
+			+ std::alignment_of<T>::value - 1);
+		const unsigned long long limit(std::numeric_limits<std::size_t>::max());
+		if((limit - offsetBytes) / sizeof(T) < valueCount)
+		{
+			throw std::bad_alloc();
+		}
+		return static_cast<std::size_t>(offsetBytes + valueCount * sizeof(T));
+	}
+
+private:
+	FlatSubsets(const FlatSubsets&);
+	FlatSubsets& operator=(const FlatSubsets&);
+
+	template<typename RandomAccessIteratorType>
+	void fill(RandomAccessIteratorType sequenceBegin, RandomAccessIteratorType sequenceEnd,
+		unsigned threadCount)
+	{
+		const std::size_t itemCount(static_cast<std::size_t>(std::distance(sequenceBegin,
+			sequenceEnd)));
+		requiredBytes(itemCount);
+		subsetCount_ = static_cast<std::size_t>(1ULL << itemCount);
+		valueCount_ = 0;
+		const std::size_t expectedValueCount(itemCount * (subsetCount_ / 2));
+		offsets_ = static_cast<std::size_t*>(arena_->allocate(
+			(subsetCount_ + 1) * sizeof(std::size_t), std::alignment_of<std::size_t>::value));
+		values_ = static_cast<T*>(arena_->allocate(expectedValueCount * sizeof(T),
+			std::alignment_of<T>::value));
+
+		// Each block of subsets knows where its items start, so the blocks can be filled in any
+		// order. A block, which throws, destroys its own items, the completed blocks are
+		// destroyed here, the destructor isn't called for a result, whose construction failed.
+		const unsigned threads(subsetThreadCount(threadCount, subsetCount_));
+		const unsigned long long blockSize(subsetBlockSize(itemCount, threads));
+		const std::size_t blockCount(static_cast<std::size_t>(subsetCount_ / blockSize));
+		std::vector<char> completed(blockCount, 0);
+		try
+		{
+			parallelForBlocks(blockCount, threads, [&](unsigned long long block)
+			{
+				fillBlock(sequenceBegin, itemCount, block * blockSize, blockSize);
+				completed[static_cast<std::size_t>(block)] = 1;
+			});
+		}
+		catch(...)
+		{
+			for(std::size_t block(0); block < blockCount; ++block)
+			{
+				if(completed[block])
+				{
+					destroyValues(static_cast<std::size_t>(subsetValueOffset(itemCount,
+						block * blockSize)), static_cast<std::size_t>(subsetValueOffset(itemCount,
+						(block + 1) * blockSize)));
+				}
+			}
+			throw;
+		}
+		valueCount_ = expectedValueCount;
+		offsets_[subsetCount_] = valueCount_;
+		assert(subsetValueOffset(itemCount, subsetCount_) == valueCount_);
+	}
+
+	// Fills the subsets with the indexes from blockBegin to blockBegin + blockSize.
+	template<typename RandomAccessIteratorType>
+	void fillBlock(RandomAccessIteratorType sequenceBegin, std::size_t itemCount,
+		unsigned long long blockBegin, unsigned long long blockSize)
+	{
+		const std::size_t valueBegin(static_cast<std::size_t>(subsetValueOffset(itemCount,
+			blockBegin)));
+		std::size_t value(valueBegin);
+		SubsetIterator<RandomAccessIteratorType> iter(sequenceBegin, itemCount, RecursiveOrder,
+			blockBegin);
+		try
+		{
+			for(std::size_t subset(static_cast<std::size_t>(blockBegin));
+				subset < blockBegin + blockSize; ++subset, ++iter)
+			{
+				offsets_[subset] = value;
+				const auto view(*iter);
+				for(auto item(view.begin()); item != view.end(); ++item)
+				{
+					// Count after constructing, so only constructed items are destroyed.
+					new(values_ + value) T(*item);
+					++value;
+				}
+			}
+		}
+		catch(...)
+		{
+			destroyValues(valueBegin, value);
+			throw;
+		}
+	}
+
+	void destroyValues(std::size_t first, std::size_t last)
+	{
+		for(std::size_t value(first); value < last; ++value)
+		{
+			values_[value].~T();
+		}
+	}
+
+	std::unique_ptr<SubsetArena> ownArena_;
+	SubsetArena* arena_;
+	std::size_t subsetCount_;
+	std::size_t valueCount_;
+	std::size_t* offsets_;
+	T* values_;
+};
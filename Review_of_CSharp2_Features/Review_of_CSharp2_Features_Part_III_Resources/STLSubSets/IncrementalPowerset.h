@@ -0,0 +1,258 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+// This header provides a powerset, which is updated in place, when items are added to or removed
+// from its input. subsets() has to be run again from scratch for a changed input, although the
+// Lisp recurrence (see "Subsets.h") shows, that adding the item x to the input l only adds
+// {cons(x, s) | s in powerset(l)} to the powerset: the old subsets stay as they are, and each new
+// subset is the item x in front of an old subset.
+// IncrementalPowerset stores each subset like a Lisp list as one node: the index of its most
+// recently added item and the index of its tail, i.e. the subset without this item, which is an
+// older subset. So the subsets share their tails instead of copying them, and adding an item to n
+// items costs only the 2^n new nodes (no item is copied). Subset i contains the item j, if bit j
+// of i is set (the bitmask of SubsetRange), thus the subsets of the first k items are the first
+// 2^k subsets, and the subsets added by the last add() are the second half of all subsets.
+// remove() drops the subsets containing the removed item, the others are moved together. Their
+// tails don't contain the removed item either, so they stay valid, only the indices are adjusted.
+// Removing the most recently added item just truncates the nodes.
+// The items of a subset are walked along its list, i.e. from the most recently added item to the
+// first added item. Each node also memoizes the size of its subset.
+
+
+// Updates the powerset of a sequence of items of type T, when items are added or removed.
+template<typename T>
+class IncrementalPowerset
+{
+	// The list node of a subset (the empty subset is node zero).
+	struct Node
+	{
+		std::size_t item;
+		std::size_t tail;
+		std::size_t size;
+	};
+
+public:
+	typedef T value_type;
+
+	// Walks the items of a subset along its list.
+	class ItemIterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
+		ItemIterator()
+			: powerset_(0), node_(0)
+		{
+		}
+
+		ItemIterator(const IncrementalPowerset& powerset, std::size_t node)
+			: powerset_(&powerset), node_(node)
+		{
+		}
+
+		reference operator*() const
+		{
+			return powerset_->items_[powerset_->nodes_[node_].item];
+		}
+
+		pointer operator->() const
+		{
+			return &**this;
+		}
+
+		ItemIterator& operator++()
+		{
+			node_ = powerset_->nodes_[node_].tail;
+			return *this;
+		}
+
+		ItemIterator operator++(int)
+		{
+			const ItemIterator old(*this);
+			++*this;
+			return old;
+		}
+
+		bool operator==(const ItemIterator& other) const
+		{
+			return node_ == other.node_;
+		}
+
+		bool operator!=(const ItemIterator& other) const
+		{
+			return node_ != other.node_;
+		}
+
+	private:
+		const IncrementalPowerset* powerset_;
+		std::size_t node_;
+	};
+
+	// A view of a subset. Adding items keeps it valid, removing items invalidates it.
+	class SubsetView
+	{
+	public:
+		typedef ItemIterator const_iterator;
+		typedef ItemIterator iterator;
+		typedef T value_type;
+		typedef std::size_t size_type;
+
+		SubsetView(const IncrementalPowerset& powerset, std::size_t node)
+			: powerset_(&powerset), node_(node)
+		{
+		}
+
+		ItemIterator begin() const
+		{
+			return ItemIterator(*powerset_, node_);
+		}
+
+		ItemIterator end() const
+		{
+			return ItemIterator(*powerset_, 0);
+		}
+
+		std::size_t size() const
+		{
+			return powerset_->nodes_[node_].size;
+		}
+
+		bool empty() const
+		{
+			return 0 == node_;
+		}
+
+	private:
+		const IncrementalPowerset* powerset_;
+		std::size_t node_;
+	};
+
+	// The powerset of no items: only the empty subset.
+	IncrementalPowerset()
+		: items_(), nodes_(1, emptyNode())
+	{
+	}
+
+	// The powerset of the items of the sequence from inputSequenceBegin to inputSequenceEnd.
+	template<typename IteratorType>
+	IncrementalPowerset(IteratorType inputSequenceBegin, IteratorType inputSequenceEnd)
+		: items_(), nodes_(1, emptyNode())
+	{
+		for(IteratorType iter(inputSequenceBegin); iter != inputSequenceEnd; ++iter)
+		{
+			add(*iter);
+		}
+	}
+
+	// Adds item to the input, this adds the subsets [size(), 2 * size()), which contain item. If an
+	// exception is thrown, the powerset is left unchanged.
+	void add(const T& item)
+	{
+		assert(items_.size() + 1 < static_cast<std::size_t>(
+			std::numeric_limits<std::size_t>::digits) && "Too many items for a powerset!");
+
+		const std::size_t count(nodes_.size());
+		nodes_.reserve(2 * count);
+		const std::size_t itemIndex(items_.size());
+		items_.push_back(item);
+		for(std::size_t tail(0); tail < count; ++tail)
+		{
+			const Node node = {itemIndex, tail, nodes_[tail].size + 1};
+			nodes_.push_back(node);
+		}
+	}
+
+	// Removes the item with the passed index (in the order of adding) from the input, i.e. the
+	// subsets containing it. The remaining subsets keep their order, the following items' indices
+	// are decremented. Only the subsets from index 2^itemIndex on are touched.
+	void remove(std::size_t itemIndex)
+	{
+		assert(itemIndex < items_.size() && "No item with this index!");
+
+		const std::size_t bit(static_cast<std::size_t>(1) << itemIndex);
+		std::size_t target(bit);
+		for(std::size_t node(2 * bit); node < nodes_.size(); ++node)
+		{
+			if(0 == (node & bit))
+			{
+				Node moved(nodes_[node]);
+				moved.item -= 1;
+				moved.tail = withoutBit(moved.tail, itemIndex);
+				nodes_[target++] = moved;
+			}
+		}
+		nodes_.resize(target);
+		items_.erase(items_.begin() + itemIndex);
+	}
+
+	// Returns the count of subsets (2^itemCount()).
+	std::size_t size() const
+	{
+		return nodes_.size();
+	}
+
+	// Returns the count of items of the input.
+	std::size_t itemCount() const
+	{
+		return items_.size();
+	}
+
+	// Returns the items of the input in the order of adding.
+	const std::vector<T>& items() const
+	{
+		return items_;
+	}
+
+	// Returns a view of the subset with the passed index.
+	SubsetView operator[](std::size_t subset) const
+	{
+		assert(subset < nodes_.size());
+		return SubsetView(*this, subset);
+	}
+
+	// Calls visitor(subset) for the subsets [first, size()) with a SubsetView. Returns the visitor
+	// (as std::for_each() does).
+	template<typename VisitorType>
+	VisitorType visit(VisitorType visitor, std::size_t first = 0) const
+	{
+		for(std::size_t subset(first); subset < nodes_.size(); ++subset)
+		{
+			visitor(SubsetView(*this, subset));
+		}
+		return visitor;
+	}
+
+	// Calls visitor(subset) for the subsets added by the most recent add(), i.e. the subsets
+	// containing the most recently added item.
+	template<typename VisitorType>
+	VisitorType visitNewest(VisitorType visitor) const
+	{
+		return visit(visitor, items_.empty() ? 0 : nodes_.size() / 2);
+	}
+
+private:
+	static Node emptyNode()
+	{
+		const Node node = {0, 0, 0};
+		return node;
+	}
+
+	// Returns the index of a subset without the item bitIndex after removing this item.
+	static std::size_t withoutBit(std::size_t subset, std::size_t bitIndex)
+	{
+		const std::size_t lowMask((static_cast<std::size_t>(1) << bitIndex) - 1);
+		return ((subset >> (bitIndex + 1)) << bitIndex) | (subset & lowMask);
+	}
+
+	std::vector<T> items_;
+	std::vector<Node> nodes_;
+};
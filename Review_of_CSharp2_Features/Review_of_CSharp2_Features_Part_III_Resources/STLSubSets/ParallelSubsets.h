@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SubsetRange.h"
+
+// This header provides the parallel mode of the subsets' generation. The recursion of
+// subsetsCore() is a binary tree (include the next item or skip it), and the subsets with the
+// indexes from k * 2^b to (k + 1) * 2^b - 1 in the order of subsets() are exactly the leaves of
+// one subtree of depth b. Such a block of subsets can be generated independently of all other
+// blocks, given the index of its first subset (see SubsetIterator).
+// The powerset is divided into many more blocks than threads. Each thread repeatedly takes the
+// next block from a shared atomic counter, so threads, which get cheaper blocks (the subsets at
+// the end of the order are smaller), just take more of them. Because the position of each subset
+// in the result is known in advance (see subsetValueOffset()), every block writes into its own
+// disjoint slots of the result, so no locks are needed and the result is the same as with the
+// serial version, for any count of threads.
+
+
+// A block must contain at least this count of subsets, smaller blocks aren't worth the
+// scheduling.
+const std::size_t MinSubsetBlockSize(1 << 10);
+
+// The count of blocks per thread, so that threads finishing early can take over work.
+const std::size_t SubsetBlocksPerThread(16);
+
+
+// Returns the count of threads to use for workItems independent pieces of work, if threadCount
+// threads were requested (zero means one thread per hardware thread). At least one thread is used.
+inline unsigned subsetThreadCount(unsigned threadCount, unsigned long long workItems)
+{
+	if(0 == threadCount)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	return static_cast<unsigned>(std::max<unsigned long long>(1,
+		std::min<unsigned long long>(threadCount, workItems)));
+}
+
+
+// Returns the count of items of all subsets of itemCount items preceding the subset with the
+// passed index in the order of subsets(). The subset with index k selects
+// itemCount - popcount(k) items, so this is itemCount * index minus the count of set bits of all
+// integers below index.
+inline unsigned long long subsetValueOffset(std::size_t itemCount, unsigned long long index)
+{
+	unsigned long long setBits(0);
+	for(std::size_t bit(0); bit < itemCount; ++bit)
+	{
+		// Each bit is set in the upper half of each period of 2^(bit + 1) integers.
+		const unsigned long long period(2ULL << bit);
+		const unsigned long long half(1ULL << bit);
+		const unsigned long long remainder(index % period);
+		setBits += (index / period) * half + (remainder > half ? remainder - half : 0);
+	}
+	return itemCount * index - setBits;
+}
+
+
+// Returns the count of subsets per block for the subsets of itemCount items generated with
+// threadCount threads. The count is a power of two, so that each block is a subtree.
+inline unsigned long long subsetBlockSize(std::size_t itemCount, unsigned threadCount)
+{
+	const unsigned long long subsetCount(1ULL << itemCount);
+	const unsigned long long wantedBlocks(static_cast<unsigned long long>(threadCount)
+		* SubsetBlocksPerThread);
+	unsigned long long blockSize(1);
+	while(blockSize < subsetCount
+		&& (blockSize < MinSubsetBlockSize || wantedBlocks < subsetCount / blockSize))
+	{
+		blockSize *= 2;
+	}
+	return blockSize;
+}
+
+
+// Calls task(block) for each block from zero to blockCount with threadCount threads, each thread
+// takes the next block not taken yet. If a task throws, the remaining blocks are skipped and the
+// first exception is rethrown after all threads are done.
+template<typename TaskType>
+void parallelForBlocks(unsigned long long blockCount, unsigned threadCount, TaskType task)
+{
+	const unsigned threads(subsetThreadCount(threadCount, blockCount));
+	if(1 == threads)
+	{
+		for(unsigned long long block(0); block < blockCount; ++block)
+		{
+			task(block);
+		}
+		return;
+	}
+
+	std::atomic<unsigned long long> nextBlock(0);
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	auto worker([&]()
+	{
+		try
+		{
+			for(unsigned long long block(nextBlock++); block < blockCount; block = nextBlock++)
+			{
+				task(block);
+			}
+		}
+		catch(...)
+		{
+			// Let the other threads run out of blocks.
+			nextBlock = blockCount;
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if(!error)
+			{
+				error = std::current_exception();
+			}
+		}
+	});
+
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	for(unsigned thread(1); thread < threads; ++thread)
+	{
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	std::for_each(workers.begin(), workers.end(), [](std::thread& thread)
+	{
+		thread.join();
+	});
+	if(error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+
+// Calculates all the subsequences of the passed sequence from inputSequenceBegin to
+// inputSequenceEnd with threadCount threads (zero means one thread per hardware thread). The
+// result is resized to 2^n subsequences, which are assigned in the order of subsets().
+template<typename ResultContainerType, typename IteratorType>
+void parallelSubsets(ResultContainerType& result, IteratorType inputSequenceBegin,
+	IteratorType inputSequenceEnd, unsigned threadCount)
+{
+	typedef typename ResultContainerType::value_type InputContainerType;
+
+	const SubsetRange<IteratorType> range(inputSequenceBegin, inputSequenceEnd, RecursiveOrder);
+	const std::size_t itemCount(static_cast<std::size_t>(std::distance(inputSequenceBegin,
+		inputSequenceEnd)));
+	result.resize(static_cast<std::size_t>(range.size()));
+
+	const unsigned threads(subsetThreadCount(threadCount, range.size()));
+	const unsigned long long blockSize(subsetBlockSize(itemCount, threads));
+	parallelForBlocks(range.size() / blockSize, threads, [&](unsigned long long block)
+	{
+		const unsigned long long blockBegin(block * blockSize);
+		SubsetIterator<IteratorType> iter(inputSequenceBegin, itemCount, RecursiveOrder,
+			blockBegin);
+		for(unsigned long long subset(blockBegin); subset < blockBegin + blockSize;
+			++subset, ++iter)
+		{
+			const auto view(*iter);
+			result[static_cast<std::size_t>(subset)] = InputContainerType(view.begin(),
+				view.end());
+		}
+	});
+}
@@ -1,72 +1,46 @@
 #include "stdafx.h"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdlib>
 #include <iterator>
+#include <list>
+#include <string>
 #include <vector>
-#include <iostream>
 #include <type_traits>
 
+#include "FlatSubsets.h"
+#include "IncrementalPowerset.h"
+#include "StaticPowerset.h"
+#include "SubsetRange.h"
+#include "Subsets.h"
+#include "SubsetTextWriter.h"
+
 // This example shows:
 // - A recursive C++/STL algorithm that generates a powerset (i.e. the set of all subsets) of a
-//   given set.
-
-//  A Lisp implementation of the subset's algorithm (this implementation gets the full powerset):
-// (defun powerset (l)
-//  (if (null l)
-//   '(nil)
-//   (let ((ps (powerset (cdr l))))
-//    (append ps (mapcar #'(lambda (x) (cons (car l) x)) ps)))))
-//
-// The core implementation of the subset algorithm.
-template<typename ResultContainerType,
-			typename IteratorType,/*Different Iter types, cause ResultContainerType can be const*/
-			typename ResultIteratorType>
-void subsetsCore(std::insert_iterator<ResultContainerType>& destination,
-					IteratorType remainderSequenceBegin, IteratorType remainderSequenceEnd,				
-					ResultIteratorType inputSequenceBegin, ResultIteratorType inputSequenceEnd)
-{
-	typedef typename ResultContainerType::value_type InputContainerType;
-	typedef typename std::iterator_traits<IteratorType>::difference_type Difftype;
-	
-	static_assert(std::is_same<typename std::iterator_traits<IteratorType>::iterator_category,
-		std::random_access_iterator_tag>::value,
-		"IteratorType's iterator_category must be random!"); 
-	static_assert(std::is_integral<Difftype>::value,
-		"IteratorType's difference_type must be integral!");
-
-	if(static_cast<Difftype>(0) == std::distance(remainderSequenceBegin, remainderSequenceEnd))
-	{
-		destination = InputContainerType(inputSequenceBegin, inputSequenceEnd);
-		++destination;
-	}
-	else
-	{
-		InputContainerType input(inputSequenceBegin, inputSequenceEnd);
-		input.insert(input.end(), remainderSequenceBegin, remainderSequenceBegin + 1);
-			
-		subsetsCore(destination, remainderSequenceBegin + 1, remainderSequenceEnd, input.begin(),
-			input.end());
-		subsetsCore(destination, remainderSequenceBegin + 1, remainderSequenceEnd,
-			inputSequenceBegin, inputSequenceEnd);
-	}
-}
-	
-	
-// This C++ algorithm calculates all the subsequences of the passed sequence from
-// inputSequenceBegin to inputSequenceEnd. The resulting subsequences will be stored into the
-// destination via an insert_iterator.
-template<typename ResultContainerType, typename IteratorType>
-void subsets(std::insert_iterator<ResultContainerType> destination, 
-	IteratorType inputSequenceBegin, IteratorType inputSequenceEnd)
-{
-	typename ResultContainerType::value_type emptySequence;
-	subsetsCore(destination, inputSequenceBegin, inputSequenceEnd, emptySequence.cbegin(),
-		emptySequence.cend());
-}
+//   given set (see "Subsets.h").
+// - Pruning the recursion to get only the subsets of a given size (combinations) or the subsets
+//   within a bound.
+// - Subsets of sequences with forward iterators, and subsets referring to the items instead of
+//   copying them.
+// - A lazy range, which enumerates the same subsets as views without allocating (see
+//   "SubsetRange.h").
+// - A compact result type, which stores all subsets in one allocation (see "FlatSubsets.h").
+// - Generating the subsets with multiple threads (see "ParallelSubsets.h").
+// - Tables of the subsets of small fixed-size inputs computed by the compiler (see
+//   "StaticPowerset.h").
+// - A powerset, which is updated, when items are added to or removed from the input, instead of
+//   being generated again (see "IncrementalPowerset.h").
+// - Visiting the subsets as they are produced, one by one or in batches, and printing them with a
+//   buffered text sink (see "SubsetTextWriter.h").
 
 
 int _tmain(int argc, _TCHAR* argv[])
 {
+	// All subsets are printed through one buffer, instead of flushing std::cout after each one.
+	SubsetTextWriter output(stdout);
+
 	//// Subsets:	
 	// With std::vector<int>:
 	typedef std::vector<int> InputContainerType;
@@ -79,16 +53,87 @@ int _tmain(int argc, _TCHAR* argv[])
 	
 	subsets(std::inserter(result, result.begin()), inputToGetSubsets.cbegin(),
 		inputToGetSubsets.cend());
-	const auto end(result.cend());
-	for(auto iter(result.cbegin()); iter < end; ++iter)
+	std::for_each(result.cbegin(), result.cend(), textSink(output));
+
+	// Sidebar: If the subsets are only consumed, they don't need to be stored at all:
+	// visitSubsets() passes each subset to the visitor as soon as it's produced, here directly to
+	// the text sink.
+	visitSubsets(inputToGetSubsets.cbegin(), inputToGetSubsets.cend(), textSink(output));
+
+	// Sidebar: Consumers with a cost per call get the subsets in batches, here of three subsets.
+	visitSubsetBatches(inputToGetSubsets.cbegin(), inputToGetSubsets.cend(), 3,
+		[&output](std::vector<InputContainerType>::const_iterator batchBegin,
+			std::vector<InputContainerType>::const_iterator batchEnd)
 	{
-		const auto innerend(iter->cend());
-		for(auto inneriter(iter->cbegin()); inneriter < innerend; ++inneriter)
+		output.write("batch: ");
+		output.write(batchEnd - batchBegin);
+		output.put('\n');
+		std::for_each(batchBegin, batchEnd, textSink(output));
+	});
+
+	// Sidebar: If only some of the subsets are needed, filtering the full powerset would throw
+	// away most of the (exponential) work. combinations() only walks the branches of the recursion
+	// leading to subsets of the passed size, here the subsets with two items.
+	ResultContainerType pairs;
+	combinations(std::inserter(pairs, pairs.begin()), inputToGetSubsets.cbegin(),
+		inputToGetSubsets.cend(), 2);
+	std::for_each(pairs.cbegin(), pairs.cend(), textSink(output));
+
+	// Sidebar: The input only needs forward iterators, e.g. of a std::list. For heavy items like
+	// strings, the subsets can refer to the items instead of copying them: the subsets of the
+	// items' references (see itemReferences()) are containers of iterators.
+	std::list<std::string> words;
+	words.push_back("zero");
+	words.push_back("one");
+	words.push_back("two");
+	typedef std::vector<std::list<std::string>::const_iterator> WordReferencesType;
+	const WordReferencesType references(itemReferences(words.cbegin(), words.cend()));
+	std::vector<WordReferencesType> wordSubsets;
+	subsets(std::inserter(wordSubsets, wordSubsets.begin()), references.cbegin(),
+		references.cend());
+	for(auto iter(wordSubsets.cbegin()); iter != wordSubsets.cend(); ++iter)
+	{
+		for(auto inneriter(iter->cbegin()); inneriter != iter->cend(); ++inneriter)
 		{
-			std::cout<<*inneriter<<' ';
+			output.write(**inneriter);
+			output.put(' ');
 		}
-		std::cout<<std::endl;
+		output.put('\n');
 	}
 
+	// Sidebar: subsets() copies each subset into its own container, and the recursion creates a
+	// temporary container on each level. If the subsets are only visited, subsetRange() yields
+	// them lazily in the same order, each subset is a view over the input selecting its items
+	// with a bitmask.
+	const auto range(subsetRange(inputToGetSubsets.cbegin(), inputToGetSubsets.cend()));
+	std::for_each(range.begin(), range.end(), textSink(output));
+
+	// Sidebar: If all subsets are needed at once, FlatSubsets stores them in one buffer (the size
+	// is known in advance: n * 2^(n - 1) items) plus an array of offsets. Instead of 2^n vectors
+	// only one block is allocated. As the position of each subset is known in advance, too, the
+	// subsets can be filled in by all cores (see "ParallelSubsets.h"), here one thread per
+	// hardware thread is requested (zero), the result is the same as with one thread.
+	const FlatSubsets<int> flatResult(inputToGetSubsets.cbegin(), inputToGetSubsets.cend(), 0);
+	for(std::size_t subset(0); subset < flatResult.size(); ++subset)
+	{
+		output(flatResult[subset]);
+	}
+
+	// Sidebar: For small inputs of a fixed size (std::array), the compiler can compute the
+	// subsets' tables (see "StaticPowerset.h"), so getting a subset is only a lookup. The visit is
+	// unrolled over all subsets.
+	const std::array<int, 3> fixedInput = {{0, 1, 2}};
+	visitStaticSubsets(fixedInput, textSink(output));
+
+	// Sidebar: If the input changes, subsets() has to start from scratch. IncrementalPowerset (see
+	// "IncrementalPowerset.h") keeps the subsets as lists sharing their tails: adding an item only
+	// adds the subsets containing it, each is a node referring to an old subset. Here the subsets
+	// added for the item 3 are printed, and then all subsets after removing the item 0 again.
+	IncrementalPowerset<int> powerset(inputToGetSubsets.cbegin(), inputToGetSubsets.cend());
+	powerset.add(3);
+	powerset.visitNewest(textSink(output));
+	powerset.remove(0);
+	powerset.visit(textSink(output));
+
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
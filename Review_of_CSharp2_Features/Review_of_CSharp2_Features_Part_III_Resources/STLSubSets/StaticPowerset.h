@@ -0,0 +1,370 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+// This header provides the powerset of small fixed-size inputs (std::array<T, N>) as tables,
+// which are computed by the compiler. For N items StaticPowerset<N> holds, in the order of
+// subsets(), the bitmask of each subset, its size and the indexes of its items. The tables are
+// built with template recursion (the compiler lacks constexpr) and a variadic pack of indexes, so
+// their initializers are constant expressions: they are placed into the read-only data of the
+// executable, there's no code running at startup. Getting a subset of an array is just a lookup:
+// staticSubset() yields a view, which walks the items through the table of the subset's indexes.
+
+
+// The largest count of items supported, the tables grow with 2^N.
+const std::size_t MaxStaticSubsetItems(10);
+
+
+// A compile-time sequence of indexes (like std::index_sequence, which isn't available yet).
+template<std::size_t... Indexes>
+struct IndexSequence
+{
+};
+
+
+// Yields the indexes of the first sequence followed by the indexes of the second sequence shifted
+// by the length of the first one as type.
+template<typename FirstSequenceType, typename SecondSequenceType>
+struct ConcatIndexSequences;
+
+template<std::size_t... FirstIndexes, std::size_t... SecondIndexes>
+struct ConcatIndexSequences<IndexSequence<FirstIndexes...>, IndexSequence<SecondIndexes...> >
+{
+	typedef IndexSequence<FirstIndexes..., (sizeof...(FirstIndexes) + SecondIndexes)...> type;
+};
+
+
+// Yields IndexSequence<0, 1, ..., Count - 1> as type. The sequence is built from two halves, so
+// that the depth of the template recursion is only log2(Count).
+template<std::size_t Count>
+struct MakeIndexSequence
+	: ConcatIndexSequences<typename MakeIndexSequence<Count / 2>::type,
+		typename MakeIndexSequence<Count - Count / 2>::type>
+{
+};
+
+template<>
+struct MakeIndexSequence<0>
+{
+	typedef IndexSequence<> type;
+};
+
+template<>
+struct MakeIndexSequence<1>
+{
+	typedef IndexSequence<0> type;
+};
+
+
+// The bitmask of the subset with the passed index of ItemCount items in the order of subsets():
+// item Bit is selected, if the bit (ItemCount - 1 - Bit) of the complement of Index is set.
+template<std::size_t ItemCount, std::size_t Index, std::size_t Bit = 0>
+struct StaticSubsetMask
+{
+	static const unsigned value = ((((~Index) >> (ItemCount - 1 - Bit)) & 1u) << Bit)
+		| StaticSubsetMask<ItemCount, Index, Bit + 1>::value;
+};
+
+template<std::size_t ItemCount, std::size_t Index>
+struct StaticSubsetMask<ItemCount, Index, ItemCount>
+{
+	static const unsigned value = 0;
+};
+
+
+// The count of set bits of Mask.
+template<unsigned Mask>
+struct StaticBitCount
+{
+	static const unsigned value = (Mask & 1u) + StaticBitCount<(Mask >> 1)>::value;
+};
+
+template<>
+struct StaticBitCount<0>
+{
+	static const unsigned value = 0;
+};
+
+
+// The index of the Nth (counting from zero) set bit of Mask, starting the search at Bit.
+template<unsigned Mask, std::size_t N, std::size_t Bit = 0, bool IsSet = 0 != (Mask & 1u)>
+struct StaticNthSetBit
+{
+	static const std::size_t value = StaticNthSetBit<(Mask >> 1), N, Bit + 1>::value;
+};
+
+template<unsigned Mask, std::size_t N, std::size_t Bit>
+struct StaticNthSetBit<Mask, N, Bit, true>
+{
+	static const std::size_t value = StaticNthSetBit<(Mask >> 1), N - 1, Bit + 1>::value;
+};
+
+template<unsigned Mask, std::size_t Bit>
+struct StaticNthSetBit<Mask, 0, Bit, true>
+{
+	static const std::size_t value = Bit;
+};
+
+// There are less than N + 1 set bits, the index is past the end.
+template<std::size_t N, std::size_t Bit>
+struct StaticNthSetBit<0, N, Bit, false>
+{
+	static const std::size_t value = Bit;
+};
+
+
+// The indexes of the items of the subset with the passed index, the entries behind the subset's
+// size are unused. It's a plain array (with room for at least one entry), because its address
+// must be a constant expression.
+template<std::size_t ItemCount, std::size_t Index, typename ItemSequenceType>
+struct StaticSubsetItems;
+
+template<std::size_t ItemCount, std::size_t Index, std::size_t... Items>
+struct StaticSubsetItems<ItemCount, Index, IndexSequence<Items...> >
+{
+	static const unsigned char indexes[ItemCount + 1];
+};
+
+template<std::size_t ItemCount, std::size_t Index, std::size_t... Items>
+const unsigned char StaticSubsetItems<ItemCount, Index, IndexSequence<Items...> >::indexes[] =
+{
+	static_cast<unsigned char>(StaticNthSetBit<StaticSubsetMask<ItemCount, Index>::value,
+		Items>::value)...
+};
+
+
+// The tables of the subsets of ItemCount items, expanded over the indexes of the subsets.
+template<std::size_t ItemCount, typename SubsetSequenceType>
+struct StaticPowersetTables;
+
+template<std::size_t ItemCount, std::size_t... Subsets>
+struct StaticPowersetTables<ItemCount, IndexSequence<Subsets...> >
+{
+	typedef typename MakeIndexSequence<ItemCount>::type ItemSequenceType;
+
+	static const std::array<unsigned, sizeof...(Subsets)> masks;
+	static const std::array<unsigned char, sizeof...(Subsets)> sizes;
+	static const std::array<const unsigned char*, sizeof...(Subsets)> items;
+};
+
+template<std::size_t ItemCount, std::size_t... Subsets>
+const std::array<unsigned, sizeof...(Subsets)>
+	StaticPowersetTables<ItemCount, IndexSequence<Subsets...> >::masks =
+{{
+	StaticSubsetMask<ItemCount, Subsets>::value...
+}};
+
+template<std::size_t ItemCount, std::size_t... Subsets>
+const std::array<unsigned char, sizeof...(Subsets)>
+	StaticPowersetTables<ItemCount, IndexSequence<Subsets...> >::sizes =
+{{
+	static_cast<unsigned char>(
+		StaticBitCount<StaticSubsetMask<ItemCount, Subsets>::value>::value)...
+}};
+
+template<std::size_t ItemCount, std::size_t... Subsets>
+const std::array<const unsigned char*, sizeof...(Subsets)>
+	StaticPowersetTables<ItemCount, IndexSequence<Subsets...> >::items =
+{{
+	StaticSubsetItems<ItemCount, Subsets, ItemSequenceType>::indexes...
+}};
+
+
+// The powerset of ItemCount items in the order of subsets():
+// - masks[k] is the bitmask of the k-th subset (bit i selects the item i),
+// - sizes[k] is the count of its items,
+// - items[k] points to the indexes of its items (in ascending order).
+template<std::size_t ItemCount>
+struct StaticPowerset
+	: StaticPowersetTables<ItemCount, typename MakeIndexSequence<(1u << ItemCount)>::type>
+{
+	static_assert(ItemCount <= MaxStaticSubsetItems, "Too many items for a static powerset!");
+
+	static const std::size_t subsetCount = 1u << ItemCount;
+};
+
+
+// Iterates the items of a std::array selected by a table of indexes.
+template<typename T>
+class StaticSubsetIterator
+{
+public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef const T& reference;
+
+	StaticSubsetIterator(const T* items, const unsigned char* index)
+		: items_(items), index_(index)
+	{
+	}
+
+	reference operator*() const
+	{
+		return items_[*index_];
+	}
+
+	pointer operator->() const
+	{
+		return items_ + *index_;
+	}
+
+	reference operator[](difference_type offset) const
+	{
+		return items_[index_[offset]];
+	}
+
+	StaticSubsetIterator& operator++()
+	{
+		++index_;
+		return *this;
+	}
+
+	StaticSubsetIterator operator++(int)
+	{
+		const StaticSubsetIterator old(*this);
+		++index_;
+		return old;
+	}
+
+	StaticSubsetIterator& operator--()
+	{
+		--index_;
+		return *this;
+	}
+
+	StaticSubsetIterator operator--(int)
+	{
+		const StaticSubsetIterator old(*this);
+		--index_;
+		return old;
+	}
+
+	StaticSubsetIterator& operator+=(difference_type offset)
+	{
+		index_ += offset;
+		return *this;
+	}
+
+	StaticSubsetIterator& operator-=(difference_type offset)
+	{
+		index_ -= offset;
+		return *this;
+	}
+
+	StaticSubsetIterator operator+(difference_type offset) const
+	{
+		return StaticSubsetIterator(items_, index_ + offset);
+	}
+
+	StaticSubsetIterator operator-(difference_type offset) const
+	{
+		return StaticSubsetIterator(items_, index_ - offset);
+	}
+
+	difference_type operator-(const StaticSubsetIterator& other) const
+	{
+		return index_ - other.index_;
+	}
+
+	bool operator==(const StaticSubsetIterator& other) const
+	{
+		return index_ == other.index_;
+	}
+
+	bool operator!=(const StaticSubsetIterator& other) const
+	{
+		return index_ != other.index_;
+	}
+
+	bool operator<(const StaticSubsetIterator& other) const
+	{
+		return index_ < other.index_;
+	}
+
+private:
+	const T* items_;
+	const unsigned char* index_;
+};
+
+
+// A subset of a std::array<T, ItemCount> looked up in StaticPowerset<ItemCount>. The view refers
+// to the array, so the array must outlive it.
+template<typename T, std::size_t ItemCount>
+class StaticSubsetView
+{
+public:
+	typedef StaticSubsetIterator<T> iterator;
+	typedef iterator const_iterator;
+	typedef T value_type;
+
+	StaticSubsetView(const std::array<T, ItemCount>& items, std::size_t subset)
+		: items_(items.data()), subset_(subset)
+	{
+	}
+
+	iterator begin() const
+	{
+		return iterator(items_, StaticPowerset<ItemCount>::items[subset_]);
+	}
+
+	iterator end() const
+	{
+		return iterator(items_,
+			StaticPowerset<ItemCount>::items[subset_] + StaticPowerset<ItemCount>::sizes[subset_]);
+	}
+
+	std::size_t size() const
+	{
+		return StaticPowerset<ItemCount>::sizes[subset_];
+	}
+
+	bool empty() const
+	{
+		return 0 == size();
+	}
+
+	unsigned mask() const
+	{
+		return StaticPowerset<ItemCount>::masks[subset_];
+	}
+
+private:
+	const T* items_;
+	std::size_t subset_;
+};
+
+
+// Returns the subset with the passed index (in the order of subsets()) of the items.
+template<typename T, std::size_t ItemCount>
+StaticSubsetView<T, ItemCount> staticSubset(const std::array<T, ItemCount>& items,
+	std::size_t subset)
+{
+	return StaticSubsetView<T, ItemCount>(items, subset);
+}
+
+
+// Calls visitor for each subset of the items with the passed indexes.
+template<typename T, std::size_t ItemCount, typename VisitorType, std::size_t... Subsets>
+void visitStaticSubsets(const std::array<T, ItemCount>& items, VisitorType& visitor,
+	IndexSequence<Subsets...>)
+{
+	// The pack expansion unrolls the loop over the subsets.
+	const int unrolled[] = {(visitor(staticSubset(items, Subsets)), 0)...};
+	static_cast<void>(unrolled);
+}
+
+
+// Calls visitor for each subset (as StaticSubsetView) of the items in the order of subsets(). The
+// calls are unrolled, so each lookup of the tables uses a constant index. Returns the visitor (as
+// std::for_each() does).
+template<typename T, std::size_t ItemCount, typename VisitorType>
+VisitorType visitStaticSubsets(const std::array<T, ItemCount>& items, VisitorType visitor)
+{
+	visitStaticSubsets(items, visitor,
+		typename MakeIndexSequence<StaticPowerset<ItemCount>::subsetCount>::type());
+	return visitor;
+}
@@ -0,0 +1,365 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// This header provides a lazy alternative to subsets(): a range, which enumerates the subsets of
+// a sequence without materializing them. Each subset is represented by a bitmask (bit i selects
+// the i-th item of the sequence), and is exposed as a SubsetView, a view over the sequence that
+// walks the selected items. Neither advancing the range nor walking a view allocates memory, so
+// callers that only visit the subsets don't need a container of containers at all.
+// The subsets can be enumerated in two orders:
+// - RecursiveOrder yields the subsets in the same order as subsets() does, e.g. for {0, 1, 2}:
+//   {0, 1, 2}, {0, 1}, {0, 2}, {0}, {1, 2}, {1}, {2}, {}.
+// - GrayCodeOrder yields the subsets so that successive subsets differ by exactly one item
+//   (starting with the empty subset), which is handy for callers, which update a result
+//   incrementally.
+// As a bitmask of 64 bits is used, sequences can have at most 63 items (a powerset of more items
+// couldn't be enumerated anyway).
+
+
+// The largest count of items the subsets can be enumerated of.
+const std::size_t MaxSubsetItems(63);
+
+
+enum SubsetOrder
+{
+	RecursiveOrder,
+	GrayCodeOrder
+};
+
+
+// Returns the index of the lowest set bit of mask, which must not be zero.
+inline unsigned lowestBit(unsigned long long mask)
+{
+	assert(0 != mask);
+#if defined(_MSC_VER)
+	unsigned long index;
+	if(_BitScanForward(&index, static_cast<unsigned long>(mask)))
+	{
+		return index;
+	}
+	_BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+	return index + 32;
+#else
+	return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+
+// Returns the index of the highest set bit of mask, which must not be zero.
+inline unsigned highestBit(unsigned long long mask)
+{
+	assert(0 != mask);
+#if defined(_MSC_VER)
+	unsigned long index;
+	if(_BitScanReverse(&index, static_cast<unsigned long>(mask >> 32)))
+	{
+		return index + 32;
+	}
+	_BitScanReverse(&index, static_cast<unsigned long>(mask));
+	return index;
+#else
+	return 63 - static_cast<unsigned>(__builtin_clzll(mask));
+#endif
+}
+
+
+// Returns the count of set bits of mask.
+inline std::size_t bitCount(unsigned long long mask)
+{
+	mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+	mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+	mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<std::size_t>((mask * 0x0101010101010101ULL) >> 56);
+}
+
+
+// Iterates the items of a sequence selected by a bitmask.
+template<typename RandomAccessIteratorType>
+class SubsetItemIterator
+{
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename std::iterator_traits<RandomAccessIteratorType>::value_type value_type;
+	typedef typename std::iterator_traits<RandomAccessIteratorType>::difference_type
+		difference_type;
+	typedef typename std::iterator_traits<RandomAccessIteratorType>::pointer pointer;
+	typedef typename std::iterator_traits<RandomAccessIteratorType>::reference reference;
+
+	SubsetItemIterator()
+		: sequence_(), mask_(0)
+	{
+	}
+
+	SubsetItemIterator(RandomAccessIteratorType sequence, unsigned long long mask)
+		: sequence_(sequence), mask_(mask)
+	{
+	}
+
+	reference operator*() const
+	{
+		return sequence_[lowestBit(mask_)];
+	}
+
+	pointer operator->() const
+	{
+		return &**this;
+	}
+
+	SubsetItemIterator& operator++()
+	{
+		// Clear the lowest set bit.
+		mask_ &= mask_ - 1;
+		return *this;
+	}
+
+	SubsetItemIterator operator++(int)
+	{
+		const SubsetItemIterator old(*this);
+		++*this;
+		return old;
+	}
+
+	bool operator==(const SubsetItemIterator& other) const
+	{
+		return mask_ == other.mask_;
+	}
+
+	bool operator!=(const SubsetItemIterator& other) const
+	{
+		return mask_ != other.mask_;
+	}
+
+private:
+	RandomAccessIteratorType sequence_;
+	unsigned long long mask_;
+};
+
+
+// A subset of a sequence: a view over the items selected by a bitmask, in the order of the
+// sequence. The view refers to the sequence, so the sequence must outlive it.
+template<typename RandomAccessIteratorType>
+class SubsetView
+{
+public:
+	typedef SubsetItemIterator<RandomAccessIteratorType> iterator;
+	typedef iterator const_iterator;
+	typedef typename iterator::value_type value_type;
+
+	SubsetView(RandomAccessIteratorType sequence, unsigned long long mask)
+		: sequence_(sequence), mask_(mask)
+	{
+	}
+
+	iterator begin() const
+	{
+		return iterator(sequence_, mask_);
+	}
+
+	iterator end() const
+	{
+		return iterator(sequence_, 0);
+	}
+
+	std::size_t size() const
+	{
+		return bitCount(mask_);
+	}
+
+	bool empty() const
+	{
+		return 0 == mask_;
+	}
+
+	// Checks, whether the item with the passed index in the sequence is part of the subset.
+	bool contains(std::size_t index) const
+	{
+		return 0 != (mask_ & (1ULL << index));
+	}
+
+	unsigned long long mask() const
+	{
+		return mask_;
+	}
+
+private:
+	RandomAccessIteratorType sequence_;
+	unsigned long long mask_;
+};
+
+
+// Returns the bitmask of the subset with the passed index of itemCount items in order.
+inline unsigned long long subsetMask(unsigned long long index, std::size_t itemCount,
+	SubsetOrder order)
+{
+	if(GrayCodeOrder == order)
+	{
+		return index ^ (index >> 1);
+	}
+
+	// The recursive order includes the first item in the first half of the subsets, the second
+	// item in the first half of each half and so on. So item i is selected, if the bit
+	// (itemCount - 1 - i) of (2^itemCount - 1 - index) is set.
+	const unsigned long long complement(((1ULL << itemCount) - 1) & ~index);
+	unsigned long long mask(0);
+	for(std::size_t item(0); item < itemCount; ++item)
+	{
+		mask |= ((complement >> (itemCount - 1 - item)) & 1ULL) << item;
+	}
+	return mask;
+}
+
+
+// Iterates the subsets of a sequence, each subset is yielded as SubsetView.
+template<typename RandomAccessIteratorType>
+class SubsetIterator
+{
+public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef SubsetView<RandomAccessIteratorType> value_type;
+	typedef long long difference_type;
+	typedef const value_type* pointer;
+	typedef value_type reference;
+
+	SubsetIterator(RandomAccessIteratorType sequence, std::size_t itemCount, SubsetOrder order,
+		unsigned long long index)
+		: sequence_(sequence), itemCount_(itemCount), order_(order), index_(index),
+			mask_(index < (1ULL << itemCount) ? subsetMask(index, itemCount, order) : 0)
+	{
+	}
+
+	value_type operator*() const
+	{
+		return value_type(sequence_, mask_);
+	}
+
+	SubsetIterator& operator++()
+	{
+		++index_;
+		if(index_ < (1ULL << itemCount_))
+		{
+			if(GrayCodeOrder == order_)
+			{
+				// The next Gray code toggles the bit of the lowest set bit of the index.
+				mask_ ^= 1ULL << lowestBit(index_);
+			}
+			else
+			{
+				// Drop the selected item with the highest index, and select all items after it.
+				const unsigned highest(highestBit(mask_));
+				mask_ &= ~(1ULL << highest);
+				mask_ |= ((1ULL << itemCount_) - 1) & ~((2ULL << highest) - 1);
+			}
+		}
+		return *this;
+	}
+
+	SubsetIterator operator++(int)
+	{
+		const SubsetIterator old(*this);
+		++*this;
+		return old;
+	}
+
+	// The index of the current subset in the order of the range.
+	unsigned long long index() const
+	{
+		return index_;
+	}
+
+	bool operator==(const SubsetIterator& other) const
+	{
+		return index_ == other.index_;
+	}
+
+	bool operator!=(const SubsetIterator& other) const
+	{
+		return index_ != other.index_;
+	}
+
+private:
+	RandomAccessIteratorType sequence_;
+	std::size_t itemCount_;
+	SubsetOrder order_;
+	unsigned long long index_;
+	unsigned long long mask_;
+};
+
+
+// The range of all subsets of the sequence from sequenceBegin to sequenceEnd. The range refers to
+// the sequence, so the sequence must outlive the range and the subsets.
+template<typename RandomAccessIteratorType>
+class SubsetRange
+{
+public:
+	typedef SubsetIterator<RandomAccessIteratorType> iterator;
+	typedef iterator const_iterator;
+	typedef SubsetView<RandomAccessIteratorType> value_type;
+
+	SubsetRange(RandomAccessIteratorType sequenceBegin, RandomAccessIteratorType sequenceEnd,
+		SubsetOrder order)
+		: sequence_(sequenceBegin),
+			itemCount_(static_cast<std::size_t>(std::distance(sequenceBegin, sequenceEnd))),
+			order_(order)
+	{
+		static_assert(std::is_same<
+			typename std::iterator_traits<RandomAccessIteratorType>::iterator_category,
+			std::random_access_iterator_tag>::value,
+			"RandomAccessIteratorType's iterator_category must be random!");
+		assert(itemCount_ <= MaxSubsetItems && "Too many items to enumerate the subsets!");
+	}
+
+	iterator begin() const
+	{
+		return iterator(sequence_, itemCount_, order_, 0);
+	}
+
+	iterator end() const
+	{
+		return iterator(sequence_, itemCount_, order_, size());
+	}
+
+	// The count of subsets, i.e. 2^itemCount.
+	unsigned long long size() const
+	{
+		return 1ULL << itemCount_;
+	}
+
+	// Returns the subset with the passed index in the order of the range.
+	value_type operator[](unsigned long long index) const
+	{
+		return value_type(sequence_, subsetMask(index, itemCount_, order_));
+	}
+
+private:
+	RandomAccessIteratorType sequence_;
+	std::size_t itemCount_;
+	SubsetOrder order_;
+};
+
+
+// Yields the lazy range of the subsets of the sequence from sequenceBegin to sequenceEnd in the
+// order of subsets().
+template<typename RandomAccessIteratorType>
+SubsetRange<RandomAccessIteratorType> subsetRange(RandomAccessIteratorType sequenceBegin,
+	RandomAccessIteratorType sequenceEnd)
+{
+	return SubsetRange<RandomAccessIteratorType>(sequenceBegin, sequenceEnd, RecursiveOrder);
+}
+
+
+// Yields the lazy range of the subsets of the sequence from sequenceBegin to sequenceEnd in the
+// passed order.
+template<typename RandomAccessIteratorType>
+SubsetRange<RandomAccessIteratorType> subsetRange(RandomAccessIteratorType sequenceBegin,
+	RandomAccessIteratorType sequenceEnd, SubsetOrder order)
+{
+	return SubsetRange<RandomAccessIteratorType>(sequenceBegin, sequenceEnd, order);
+}
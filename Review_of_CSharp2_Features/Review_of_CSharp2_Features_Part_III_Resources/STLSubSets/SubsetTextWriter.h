@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// This header provides a fast sink for printing subsets as text. std::cout<<item<<std::endl
+// formats each item through the stream's locale and flushes the stream after each subset, i.e.
+// the output takes one system call per subset. SubsetTextWriter formats integers itself and
+// collects the text in a buffer, which is written to the file only when it's full (and when the
+// writer is flushed or destroyed). Each subset is written as a line, each item followed by a
+// space (the format of the example's loops). Pass a SubsetTextSink (see textSink()) as visitor,
+// e.g. to visitSubsets() or std::for_each().
+
+
+// The default size of the buffer of a SubsetTextWriter.
+const std::size_t DefaultSubsetTextBufferSize(1 << 16);
+
+
+// Writes subsets as lines of text into a file through a buffer.
+class SubsetTextWriter
+{
+public:
+	explicit SubsetTextWriter(std::FILE* file, std::size_t bufferSize = DefaultSubsetTextBufferSize)
+		: file_(file), buffer_(bufferSize < 64 ? 64 : bufferSize), used_(0)
+	{
+	}
+
+	~SubsetTextWriter()
+	{
+		flush();
+	}
+
+	// Writes the items of the subset followed by the end of the line.
+	template<typename SubsetType>
+	void operator()(const SubsetType& subset)
+	{
+		for(auto item(subset.begin()); item != subset.end(); ++item)
+		{
+			write(*item);
+			put(' ');
+		}
+		put('\n');
+	}
+
+	// Writes an integer in decimal.
+	template<typename IntegerType>
+	typename std::enable_if<std::is_integral<IntegerType>::value>::type write(IntegerType value)
+	{
+		// Enough for the digits (and a sign) of a 64-bit integer.
+		char digits[24];
+		char* first(digits + sizeof(digits));
+		const bool negative(value < 0);
+		// Negate digit by digit, so the smallest negative value doesn't overflow.
+		do
+		{
+			const int digit(static_cast<int>(value % 10));
+			*--first = static_cast<char>('0' + (negative ? -digit : digit));
+			value /= 10;
+		}
+		while(0 != value);
+		if(negative)
+		{
+			*--first = '-';
+		}
+		write(first, static_cast<std::size_t>(digits + sizeof(digits) - first));
+	}
+
+	void write(const std::string& text)
+	{
+		write(text.data(), text.size());
+	}
+
+	void write(const char* text)
+	{
+		write(text, std::strlen(text));
+	}
+
+	void write(const char* text, std::size_t length)
+	{
+		if(buffer_.size() - used_ < length)
+		{
+			flush();
+			if(buffer_.size() < length)
+			{
+				// Too long for the buffer, write it through.
+				std::fwrite(text, 1, length, file_);
+				return;
+			}
+		}
+		std::memcpy(&buffer_[used_], text, length);
+		used_ += length;
+	}
+
+	void put(char character)
+	{
+		if(buffer_.size() == used_)
+		{
+			flush();
+		}
+		buffer_[used_++] = character;
+	}
+
+	// Writes the buffered text to the file.
+	void flush()
+	{
+		if(0 != used_)
+		{
+			std::fwrite(&buffer_[0], 1, used_, file_);
+			used_ = 0;
+		}
+		std::fflush(file_);
+	}
+
+private:
+	SubsetTextWriter(const SubsetTextWriter&);
+	SubsetTextWriter& operator=(const SubsetTextWriter&);
+
+	std::FILE* file_;
+	std::vector<char> buffer_;
+	std::size_t used_;
+};
+
+
+// A copyable visitor writing each subset to a SubsetTextWriter, which must outlive it.
+class SubsetTextSink
+{
+public:
+	explicit SubsetTextSink(SubsetTextWriter& writer)
+		: writer_(&writer)
+	{
+	}
+
+	template<typename SubsetType>
+	void operator()(const SubsetType& subset) const
+	{
+		(*writer_)(subset);
+	}
+
+private:
+	SubsetTextWriter* writer_;
+};
+
+
+// Yields a visitor writing each subset to writer.
+inline SubsetTextSink textSink(SubsetTextWriter& writer)
+{
+	return SubsetTextSink(writer);
+}
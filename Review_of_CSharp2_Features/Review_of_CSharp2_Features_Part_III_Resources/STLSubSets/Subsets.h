@@ -0,0 +1,356 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+// This header provides the recursive subsets' algorithm: subsets() generates the powerset of a
+// sequence, combinations(), boundedSubsets() and prunedSubsets() prune the recursion to get only
+// some of the subsets. visitSubsets() and visitSubsetBatches() pass the subsets to a visitor as
+// they are produced instead of storing them.
+
+
+//  A Lisp implementation of the subset's algorithm (this implementation gets the full powerset):
+// (defun powerset (l)
+//  (if (null l)
+//   '(nil)
+//   (let ((ps (powerset (cdr l))))
+//    (append ps (mapcar #'(lambda (x) (cons (car l) x)) ps)))))
+//
+// The recursion can be pruned: each call of subsetsCore() is the root of the subsets, which
+// extend the subset built so far by items of the remainder. A filter tells, whether any of these
+// subsets can still be accepted (feasible()), if not, the whole branch is cut off. The filter is
+// passed by value, and including() yields the filter for the branch including the next item, so
+// filters can track their state incrementally (e.g. a size or a running sum).
+
+
+// The filter of subsets(): every subset is accepted.
+struct AllSubsets
+{
+	template<typename IteratorType, typename DiffType>
+	bool feasible(IteratorType, IteratorType, DiffType) const
+	{
+		return true;
+	}
+
+	template<typename T>
+	AllSubsets including(const T&) const
+	{
+		return *this;
+	}
+};
+
+
+// The filter of combinations(): accepts the subsets with exactly k items. A branch is cut off, if
+// it already has more than k items or if the remainder can't fill it up to k items.
+class CombinationFilter
+{
+public:
+	explicit CombinationFilter(std::size_t k, std::size_t size = 0)
+		: k_(k), size_(size)
+	{
+	}
+
+	template<typename IteratorType, typename DiffType>
+	bool feasible(IteratorType, IteratorType, DiffType remainderCount) const
+	{
+		return size_ <= k_ && k_ - size_ <= static_cast<std::size_t>(remainderCount);
+	}
+
+	template<typename T>
+	CombinationFilter including(const T&) const
+	{
+		return CombinationFilter(k_, size_ + 1);
+	}
+
+private:
+	std::size_t k_;
+	std::size_t size_;
+};
+
+
+// The filter of boundedSubsets(): accepts the subsets, whose sum of the weights of their items
+// doesn't exceed the bound. The weights must not be negative, so that a branch, which exceeds the
+// bound, can be cut off.
+template<typename WeightFunctionType, typename WeightType>
+class WeightBoundFilter
+{
+public:
+	WeightBoundFilter(WeightFunctionType weight, WeightType bound, WeightType total)
+		: weight_(weight), bound_(bound), total_(total)
+	{
+	}
+
+	template<typename IteratorType, typename DiffType>
+	bool feasible(IteratorType, IteratorType, DiffType) const
+	{
+		return !(bound_ < total_);
+	}
+
+	template<typename T>
+	WeightBoundFilter including(const T& item) const
+	{
+		return WeightBoundFilter(weight_, bound_, total_ + weight_(item));
+	}
+
+private:
+	WeightFunctionType weight_;
+	WeightType bound_;
+	WeightType total_;
+};
+
+
+// The filter of prunedSubsets(): accepts the subsets accepted by the predicate, which is called
+// with the range of a (partial) subset. The predicate must be monotone: if it rejects a subset,
+// it must reject all of its supersets, so that a rejected branch can be cut off.
+template<typename PredicateType>
+class MonotonePredicateFilter
+{
+public:
+	explicit MonotonePredicateFilter(PredicateType predicate)
+		: predicate_(predicate)
+	{
+	}
+
+	template<typename IteratorType, typename DiffType>
+	bool feasible(IteratorType subsetBegin, IteratorType subsetEnd, DiffType) const
+	{
+		return predicate_(subsetBegin, subsetEnd);
+	}
+
+	template<typename T>
+	MonotonePredicateFilter including(const T&) const
+	{
+		return *this;
+	}
+
+private:
+	PredicateType predicate_;
+};
+
+
+// The sink of subsets(): inserts each subset into the destination.
+template<typename ResultContainerType>
+class InserterSink
+{
+public:
+	explicit InserterSink(std::insert_iterator<ResultContainerType>& destination)
+		: destination_(&destination)
+	{
+	}
+
+	void operator()(const typename ResultContainerType::value_type& subset)
+	{
+		**destination_ = subset;
+		++*destination_;
+	}
+
+private:
+	std::insert_iterator<ResultContainerType>* destination_;
+};
+
+
+// The core implementation of the subset algorithm. The subset built so far is a single container,
+// which is extended by the next item before the branch including it, and shrunk again afterwards.
+// So the recursion only copies each item once per branch, and only the accepted subsets are
+// passed as a whole to the sink, which is called once per subset (e.g. copies it into a
+// destination). The remainder's count is passed along, so forward iterators (e.g. of a std::list)
+// don't need to be walked to get it.
+template<typename SinkType, typename IteratorType, typename SubsetType, typename FilterType>
+void subsetsCore(SinkType& sink,
+					IteratorType remainderSequenceBegin, IteratorType remainderSequenceEnd,
+					typename std::iterator_traits<IteratorType>::difference_type remainderCount,
+					SubsetType& subset, const FilterType& filter)
+{
+	typedef typename std::iterator_traits<IteratorType>::difference_type Difftype;
+	
+	static_assert(std::is_base_of<std::forward_iterator_tag,
+		typename std::iterator_traits<IteratorType>::iterator_category>::value,
+		"IteratorType's iterator_category must be forward at least!"); 
+	static_assert(std::is_integral<Difftype>::value,
+		"IteratorType's difference_type must be integral!");
+
+	if(!filter.feasible(subset.cbegin(), subset.cend(), remainderCount))
+	{
+		return;
+	}
+
+	if(remainderSequenceBegin == remainderSequenceEnd)
+	{
+		sink(static_cast<const SubsetType&>(subset));
+	}
+	else
+	{
+		IteratorType next(remainderSequenceBegin);
+		++next;
+
+		subset.push_back(*remainderSequenceBegin);
+		subsetsCore(sink, next, remainderSequenceEnd, remainderCount - 1, subset,
+			filter.including(*remainderSequenceBegin));
+		subset.pop_back();
+		subsetsCore(sink, next, remainderSequenceEnd, remainderCount - 1, subset, filter);
+	}
+}
+
+
+// Calls the core implementation with an empty subset built so far.
+template<typename ResultContainerType, typename IteratorType, typename FilterType>
+void filteredSubsets(std::insert_iterator<ResultContainerType>& destination,
+	IteratorType inputSequenceBegin, IteratorType inputSequenceEnd, const FilterType& filter)
+{
+	InserterSink<ResultContainerType> sink(destination);
+	typename ResultContainerType::value_type subset;
+	subsetsCore(sink, inputSequenceBegin, inputSequenceEnd,
+		std::distance(inputSequenceBegin, inputSequenceEnd), subset, filter);
+}
+
+
+// Collects the subsets passed to it into batches of batchSize subsets, and calls
+// batchVisitor(batchBegin, batchEnd) with the range of each full batch. The subsets of a batch
+// are reused for the next batch, so after the first batch no memory is allocated any more. The
+// batch is only valid during the call of batchVisitor.
+template<typename SubsetType, typename BatchVisitorType>
+class SubsetBatcher
+{
+public:
+	typedef typename std::vector<SubsetType>::const_iterator BatchIteratorType;
+
+	SubsetBatcher(std::size_t batchSize, BatchVisitorType& batchVisitor)
+		: batch_(), batchSize_(0 == batchSize ? 1 : batchSize), count_(0),
+			batchVisitor_(&batchVisitor)
+	{
+		batch_.reserve(batchSize_);
+	}
+
+	void operator()(const SubsetType& subset)
+	{
+		if(count_ < batch_.size())
+		{
+			batch_[count_].assign(subset.begin(), subset.end());
+		}
+		else
+		{
+			batch_.push_back(subset);
+		}
+		if(batchSize_ == ++count_)
+		{
+			flush();
+		}
+	}
+
+	// Passes the subsets collected in the current batch (if any) to the batch visitor.
+	void flush()
+	{
+		if(0 != count_)
+		{
+			(*batchVisitor_)(batch_.cbegin(), batch_.cbegin() + count_);
+			count_ = 0;
+		}
+	}
+
+private:
+	std::vector<SubsetType> batch_;
+	std::size_t batchSize_;
+	std::size_t count_;
+	BatchVisitorType* batchVisitor_;
+};
+
+
+// Returns iterators to the items of the sequence from inputSequenceBegin to inputSequenceEnd. The
+// subsets of the returned references (e.g. by subsets() or combinations()) refer to the items
+// instead of copying them, which pays off for heavy items like strings. The sequence must outlive
+// the subsets.
+template<typename IteratorType>
+std::vector<IteratorType> itemReferences(IteratorType inputSequenceBegin,
+	IteratorType inputSequenceEnd)
+{
+	std::vector<IteratorType> references;
+	for(IteratorType iter(inputSequenceBegin); iter != inputSequenceEnd; ++iter)
+	{
+		references.push_back(iter);
+	}
+	return references;
+}
+	
+	
+// This C++ algorithm calculates all the subsequences of the passed sequence from
+// inputSequenceBegin to inputSequenceEnd. The resulting subsequences will be stored into the
+// destination via an insert_iterator. The subsequences' container type must provide push_back()
+// and pop_back() (like std::vector, std::deque, std::list or std::basic_string do).
+template<typename ResultContainerType, typename IteratorType>
+void subsets(std::insert_iterator<ResultContainerType> destination, 
+	IteratorType inputSequenceBegin, IteratorType inputSequenceEnd)
+{
+	filteredSubsets(destination, inputSequenceBegin, inputSequenceEnd, AllSubsets());
+}
+
+
+// Calculates the subsequences with k items of the passed sequence (in the order of subsets()).
+// Only the C(n, k) branches leading to such subsequences are walked.
+template<typename ResultContainerType, typename IteratorType>
+void combinations(std::insert_iterator<ResultContainerType> destination,
+	IteratorType inputSequenceBegin, IteratorType inputSequenceEnd, std::size_t k)
+{
+	filteredSubsets(destination, inputSequenceBegin, inputSequenceEnd, CombinationFilter(k));
+}
+
+
+// Calculates the subsequences of the passed sequence, whose sum of weight(item) doesn't exceed
+// bound (in the order of subsets()). The weights must not be negative.
+template<typename ResultContainerType, typename IteratorType, typename WeightFunctionType,
+	typename WeightType>
+void boundedSubsets(std::insert_iterator<ResultContainerType> destination,
+	IteratorType inputSequenceBegin, IteratorType inputSequenceEnd, WeightFunctionType weight,
+	WeightType bound)
+{
+	filteredSubsets(destination, inputSequenceBegin, inputSequenceEnd,
+		WeightBoundFilter<WeightFunctionType, WeightType>(weight, bound, WeightType()));
+}
+
+
+// Calculates the subsequences of the passed sequence, which are accepted by
+// predicate(subsetBegin, subsetEnd) (in the order of subsets()). The predicate must be monotone,
+// i.e. reject all supersets of a rejected subsequence.
+template<typename ResultContainerType, typename IteratorType, typename PredicateType>
+void prunedSubsets(std::insert_iterator<ResultContainerType> destination,
+	IteratorType inputSequenceBegin, IteratorType inputSequenceEnd, PredicateType predicate)
+{
+	filteredSubsets(destination, inputSequenceBegin, inputSequenceEnd,
+		MonotonePredicateFilter<PredicateType>(predicate));
+}
+
+
+// Calls visitor(subset) for each subsequence of the passed sequence in the order of subsets(),
+// but without storing them: each subset is passed as a const std::vector of the items, which is
+// only valid during the call. The visitor is called directly (and can be inlined), so the subsets
+// can be consumed (e.g. hashed, aggregated or written) as they are produced. Returns the visitor
+// (as std::for_each() does).
+template<typename IteratorType, typename VisitorType>
+VisitorType visitSubsets(IteratorType inputSequenceBegin, IteratorType inputSequenceEnd,
+	VisitorType visitor)
+{
+	std::vector<typename std::iterator_traits<IteratorType>::value_type> subset;
+	subsetsCore(visitor, inputSequenceBegin, inputSequenceEnd,
+		std::distance(inputSequenceBegin, inputSequenceEnd), subset, AllSubsets());
+	return visitor;
+}
+
+
+// Calls batchVisitor(batchBegin, batchEnd) for each batch of (at most) batchSize subsequences of
+// the passed sequence in the order of subsets(). The range of a batch iterates const
+// std::vectors of the items, which are only valid during the call. Batches suit consumers, which
+// have a cost per call (e.g. sending over a network). Returns the batch visitor.
+template<typename IteratorType, typename BatchVisitorType>
+BatchVisitorType visitSubsetBatches(IteratorType inputSequenceBegin,
+	IteratorType inputSequenceEnd, std::size_t batchSize, BatchVisitorType batchVisitor)
+{
+	typedef std::vector<typename std::iterator_traits<IteratorType>::value_type> SubsetType;
+
+	SubsetBatcher<SubsetType, BatchVisitorType> batcher(batchSize, batchVisitor);
+	SubsetType subset;
+	subsetsCore(batcher, inputSequenceBegin, inputSequenceEnd,
+		std::distance(inputSequenceBegin, inputSequenceEnd), subset, AllSubsets());
+	batcher.flush();
+	return batchVisitor;
+}
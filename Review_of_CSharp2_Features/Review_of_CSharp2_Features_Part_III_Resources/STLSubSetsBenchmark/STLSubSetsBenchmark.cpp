@@ -0,0 +1,661 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <chrono>
+#include <sys/resource.h>
+#endif
+
+#include "FlatSubsets.h"
+#include "IncrementalPowerset.h"
+#include "ParallelSubsets.h"
+#include "SubsetRange.h"
+#include "Subsets.h"
+
+// This benchmark generates the powerset of n items for n from 4 to maxItems with subsets() and
+// its alternatives, for three types of items: int, std::string (long enough to live on the heap)
+// and a large POD (256 bytes). For each variant, type and n it reports the wall time of the
+// generation and of the release of the result, the count of heap allocations and allocated bytes,
+// the peak of the heap in use (all per run) and the peak resident memory of the process so far,
+// which includes the peaks of the variants run before. The results are written as JSON to
+// stdout, so redirect the output to keep them:
+//   STLSubSetsBenchmark.exe [maxItems=26] [threads=0 (all)] [memoryLimitMB=1024] > results.json
+// The variants are:
+// - recursive: subsets() into a std::vector<std::vector<T> > (the example's algorithm, the
+//   baseline for all other variants),
+// - references: subsets() of the items' references (see itemReferences()),
+// - visit: visitSubsets() with a visitor summing up the items, i.e. without storing the subsets,
+// - lazy: visiting all subsets of subsetRange() (see "SubsetRange.h"),
+// - flat: a FlatSubsets<T> (see "FlatSubsets.h"),
+// - flatParallel: a FlatSubsets<T> filled with the passed count of threads,
+// - parallel: parallelSubsets() into a std::vector<std::vector<T> > (see "ParallelSubsets.h").
+// - incremental: adding the last item to an IncrementalPowerset<T> of the other items (see
+//   "IncrementalPowerset.h"), only the update and the release of the whole powerset are measured,
+//   and only the subsets added by the update are counted.
+// The heap is counted by replacing the global operator new and delete, so every allocation of
+// the containers and the items is included, from the construction of the variant's ReleaseClock
+// to its destruction. A variant, whose result would exceed the memory
+// limit (estimated in advance), or which fails to allocate, is reported with an error and not
+// run for larger n. The visiting variants don't materialize, they run up to maxItems.
+
+
+// The bytes in front of each counted allocation, which hold its size. The header keeps the
+// alignment of malloc().
+const std::size_t AllocationHeaderBytes(16);
+
+// The length of the std::string items, longer than any small string buffer.
+const std::size_t StringItemLength(32);
+
+
+// The counters of the heap, which are updated by all threads.
+std::atomic<unsigned long long> allocationCount;
+std::atomic<unsigned long long> allocatedBytes;
+std::atomic<unsigned long long> heapBytesInUse;
+std::atomic<unsigned long long> peakHeapBytesInUse;
+
+
+// Allocates size bytes and counts the allocation, returns null, if the heap is exhausted.
+void* countedAllocate(std::size_t size)
+{
+	if(static_cast<std::size_t>(-1) - AllocationHeaderBytes < size)
+	{
+		return 0;
+	}
+	char* const block(static_cast<char*>(std::malloc(size + AllocationHeaderBytes)));
+	if(0 == block)
+	{
+		return 0;
+	}
+	*reinterpret_cast<std::size_t*>(block) = size;
+	++allocationCount;
+	allocatedBytes += size;
+	const unsigned long long inUse(heapBytesInUse += size);
+	unsigned long long peak(peakHeapBytesInUse.load());
+	while(peak < inUse && !peakHeapBytesInUse.compare_exchange_weak(peak, inUse))
+	{
+	}
+	return block + AllocationHeaderBytes;
+}
+
+
+// Frees memory allocated by countedAllocate().
+void countedFree(void* memory)
+{
+	if(0 != memory)
+	{
+		char* const block(static_cast<char*>(memory) - AllocationHeaderBytes);
+		heapBytesInUse -= *reinterpret_cast<std::size_t*>(block);
+		std::free(block);
+	}
+}
+
+
+void* operator new(std::size_t size)
+{
+	void* const memory(countedAllocate(0 == size ? 1 : size));
+	if(0 == memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) throw()
+{
+	return countedAllocate(0 == size ? 1 : size);
+}
+
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+
+void* operator new[](std::size_t size, const std::nothrow_t&) throw()
+{
+	return countedAllocate(0 == size ? 1 : size);
+}
+
+
+void operator delete(void* memory) throw()
+{
+	countedFree(memory);
+}
+
+
+void operator delete(void* memory, const std::nothrow_t&) throw()
+{
+	countedFree(memory);
+}
+
+
+// The sized forms (C++14) are called instead of the unsized ones, if they're available.
+void operator delete(void* memory, std::size_t) throw()
+{
+	operator delete(memory);
+}
+
+
+void operator delete[](void* memory) throw()
+{
+	countedFree(memory);
+}
+
+
+void operator delete[](void* memory, const std::nothrow_t&) throw()
+{
+	countedFree(memory);
+}
+
+
+void operator delete[](void* memory, std::size_t) throw()
+{
+	operator delete[](memory);
+}
+
+
+// Returns the seconds elapsed since an arbitrary point in time.
+double now()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+// Returns the peak resident memory (working set) of the process in bytes so far.
+unsigned long long peakResidentBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+		? static_cast<unsigned long long>(counters.PeakWorkingSetSize)
+		: 0;
+#else
+	rusage usage;
+	return 0 == getrusage(RUSAGE_SELF, &usage)
+		? static_cast<unsigned long long>(usage.ru_maxrss) * 1024
+		: 0;
+#endif
+}
+
+
+// Writes text as JSON string, quotes, backslashes and control characters are escaped.
+void printJsonString(const char* text)
+{
+	std::putchar('"');
+	for(const char* iter(text); *iter; ++iter)
+	{
+		const unsigned char character(static_cast<unsigned char>(*iter));
+		if('"' == character || '\\' == character)
+		{
+			std::printf("\\%c", character);
+		}
+		else if(character < 0x20)
+		{
+			std::printf("\\u%04x", character);
+		}
+		else
+		{
+			std::putchar(character);
+		}
+	}
+	std::putchar('"');
+}
+
+
+// The visiting variants store the sum of their items here, so that visiting them isn't optimized away.
+volatile std::size_t checksumSink;
+
+
+// A large item, which is copied byte by byte.
+struct LargePod
+{
+	int values[64];
+};
+
+
+// The traits of the types of items: the name, the creation of the item with the passed index,
+// the heap bytes an item holds besides its own size (for the estimate of the memory limit) and a
+// value of the item, which the visiting variants sum up.
+template<typename T>
+struct ItemTraits;
+
+template<>
+struct ItemTraits<int>
+{
+	static const char* name()
+	{
+		return "int";
+	}
+
+	static int create(std::size_t index)
+	{
+		return static_cast<int>(index);
+	}
+
+	static std::size_t heapBytes()
+	{
+		return 0;
+	}
+
+	static std::size_t checksum(int item)
+	{
+		return static_cast<std::size_t>(item);
+	}
+};
+
+template<>
+struct ItemTraits<std::string>
+{
+	static const char* name()
+	{
+		return "string";
+	}
+
+	static std::string create(std::size_t index)
+	{
+		return std::string(StringItemLength, static_cast<char>('a' + index % 26));
+	}
+
+	static std::size_t heapBytes()
+	{
+		return StringItemLength + 1 + AllocationHeaderBytes;
+	}
+
+	static std::size_t checksum(const std::string& item)
+	{
+		return item.size();
+	}
+};
+
+template<>
+struct ItemTraits<LargePod>
+{
+	static const char* name()
+	{
+		return "largePod";
+	}
+
+	static LargePod create(std::size_t index)
+	{
+		LargePod item;
+		std::fill(item.values, item.values + sizeof(item.values) / sizeof(item.values[0]),
+			static_cast<int>(index));
+		return item;
+	}
+
+	static std::size_t heapBytes()
+	{
+		return 0;
+	}
+
+	static std::size_t checksum(const LargePod& item)
+	{
+		return static_cast<std::size_t>(item.values[0]);
+	}
+};
+
+
+// The measurements of the runs of a variant, accumulated over all repetitions.
+struct Measurement
+{
+	Measurement()
+		: generateSeconds(0), releaseSeconds(0), allocations(0), allocatedBytes(0),
+			peakHeapBytes(0), resultCount(0)
+	{
+	}
+
+	double generateSeconds;
+	double releaseSeconds;
+	unsigned long long allocations;
+	unsigned long long allocatedBytes;
+	unsigned long long peakHeapBytes;
+	unsigned long long resultCount;
+};
+
+
+// Measures one run of a variant: from its construction to generated() is the generation, from
+// there to its destruction the release of the result. So it must be constructed before the
+// result. The heap is counted from its construction to its destruction, the peak of the heap
+// relative to the heap in use at its construction.
+class ReleaseClock
+{
+public:
+	explicit ReleaseClock(Measurement& measurement)
+		: measurement_(measurement), allocations_(allocationCount.load()),
+			allocatedBytes_(allocatedBytes.load()), heapBytes_(heapBytesInUse.load()),
+			start_(now()), generated_(start_)
+	{
+		peakHeapBytesInUse = heapBytes_;
+	}
+
+	void generated()
+	{
+		generated_ = now();
+		measurement_.generateSeconds += generated_ - start_;
+	}
+
+	~ReleaseClock()
+	{
+		measurement_.releaseSeconds += now() - generated_;
+		measurement_.allocations += allocationCount.load() - allocations_;
+		measurement_.allocatedBytes += allocatedBytes.load() - allocatedBytes_;
+		measurement_.peakHeapBytes = std::max(measurement_.peakHeapBytes,
+			peakHeapBytesInUse.load() - heapBytes_);
+	}
+
+private:
+	ReleaseClock(const ReleaseClock&);
+	ReleaseClock& operator=(const ReleaseClock&);
+
+	Measurement& measurement_;
+	unsigned long long allocations_;
+	unsigned long long allocatedBytes_;
+	unsigned long long heapBytes_;
+	double start_;
+	double generated_;
+};
+
+
+// The variants for items of type T. Each variant generates all subsets of items once and
+// accumulates its times in measurement.
+template<typename T>
+struct Variants
+{
+	typedef void (*VariantType)(const std::vector<T>& items, unsigned threadCount,
+		Measurement& measurement);
+
+	// The example's algorithm.
+	static void recursive(const std::vector<T>& items, unsigned, Measurement& measurement)
+	{
+		ReleaseClock clock(measurement);
+		std::vector<std::vector<T> > result;
+		subsets(std::inserter(result, result.begin()), items.cbegin(), items.cend());
+		clock.generated();
+		measurement.resultCount = result.size();
+	}
+
+	// The subsets of the items' references.
+	static void references(const std::vector<T>& items, unsigned, Measurement& measurement)
+	{
+		typedef std::vector<typename std::vector<T>::const_iterator> ReferencesType;
+
+		ReleaseClock clock(measurement);
+		std::vector<ReferencesType> result;
+		const ReferencesType itemsReferences(itemReferences(items.cbegin(), items.cend()));
+		subsets(std::inserter(result, result.begin()), itemsReferences.cbegin(),
+			itemsReferences.cend());
+		clock.generated();
+		measurement.resultCount = result.size();
+	}
+
+	// Visits each subset produced by the recursion.
+	static void visit(const std::vector<T>& items, unsigned, Measurement& measurement)
+	{
+		ReleaseClock clock(measurement);
+		std::size_t checksum(0);
+		unsigned long long subsetCount(0);
+		visitSubsets(items.cbegin(), items.cend(), [&](const std::vector<T>& subset)
+		{
+			for(auto item(subset.begin()); item != subset.end(); ++item)
+			{
+				checksum += ItemTraits<T>::checksum(*item);
+			}
+			++subsetCount;
+		});
+		clock.generated();
+		checksumSink = checksum;
+		measurement.resultCount = subsetCount;
+	}
+
+	// Visits each item of each subset of the lazy range.
+	static void lazy(const std::vector<T>& items, unsigned, Measurement& measurement)
+	{
+		ReleaseClock clock(measurement);
+		const auto range(subsetRange(items.cbegin(), items.cend()));
+		std::size_t checksum(0);
+		for(auto iter(range.begin()); iter != range.end(); ++iter)
+		{
+			const auto subset(*iter);
+			for(auto item(subset.begin()); item != subset.end(); ++item)
+			{
+				checksum += ItemTraits<T>::checksum(*item);
+			}
+		}
+		clock.generated();
+		checksumSink = checksum;
+		measurement.resultCount = range.size();
+	}
+
+	// The flat result type filled by one thread.
+	static void flat(const std::vector<T>& items, unsigned, Measurement& measurement)
+	{
+		ReleaseClock clock(measurement);
+		const FlatSubsets<T> result(items.cbegin(), items.cend(), 1);
+		clock.generated();
+		measurement.resultCount = result.size();
+	}
+
+	// The flat result type filled by threadCount threads.
+	static void flatParallel(const std::vector<T>& items, unsigned threadCount,
+		Measurement& measurement)
+	{
+		ReleaseClock clock(measurement);
+		const FlatSubsets<T> result(items.cbegin(), items.cend(), threadCount);
+		clock.generated();
+		measurement.resultCount = result.size();
+	}
+
+	// The nested result filled by threadCount threads.
+	static void parallel(const std::vector<T>& items, unsigned threadCount,
+		Measurement& measurement)
+	{
+		ReleaseClock clock(measurement);
+		std::vector<std::vector<T> > result;
+		parallelSubsets(result, items.cbegin(), items.cend(), threadCount);
+		clock.generated();
+		measurement.resultCount = result.size();
+	}
+
+	// The update of the powerset of all items but the last one by adding the last one. The
+	// powerset of the other items is built before the clock, and handed to the result after it,
+	// so the clock measures the release of the whole powerset, but not its construction.
+	static void incremental(const std::vector<T>& items, unsigned, Measurement& measurement)
+	{
+		std::unique_ptr<IncrementalPowerset<T> > base(
+			new IncrementalPowerset<T>(items.cbegin(), items.cend() - 1));
+		ReleaseClock clock(measurement);
+		const std::unique_ptr<IncrementalPowerset<T> > result(std::move(base));
+		const std::size_t baseCount(result->size());
+		result->add(items.back());
+		clock.generated();
+		measurement.resultCount = result->size() - baseCount;
+	}
+};
+
+
+// The kinds of results of the variants, which determine the estimate of their memory.
+enum ResultKind
+{
+	NestedResult,
+	ReferencesResult,
+	NoResult,
+	FlatResult,
+	IncrementalResult
+};
+
+
+// Returns the estimated peak of the heap in bytes of a result of the passed kind for the subsets
+// of itemCount items of type T.
+template<typename T>
+double estimatedBytes(ResultKind kind, std::size_t itemCount)
+{
+	const double subsetCount(static_cast<double>(1ULL << itemCount));
+	const double valueCount(subsetCount / 2 * itemCount);
+	switch(kind)
+	{
+	case NestedResult:
+		// The outer vector grows by copying, each subset is a separate block.
+		return subsetCount * 2 * sizeof(std::vector<T>)
+			+ subsetCount * AllocationHeaderBytes
+			+ valueCount * (sizeof(T) + ItemTraits<T>::heapBytes());
+	case ReferencesResult:
+		return subsetCount * 2 * sizeof(std::vector<const T*>)
+			+ subsetCount * AllocationHeaderBytes + valueCount * sizeof(const T*);
+	case FlatResult:
+		return subsetCount * sizeof(std::size_t)
+			+ valueCount * (sizeof(T) + ItemTraits<T>::heapBytes());
+	case IncrementalResult:
+		// A node of three indices per subset, the nodes are moved, when they are doubled.
+		return subsetCount * 3 / 2 * 3 * sizeof(std::size_t)
+			+ itemCount * (sizeof(T) + ItemTraits<T>::heapBytes());
+	default:
+		return 0;
+	}
+}
+
+
+// Runs a variant on itemCount items (repeatedly for small counts) and writes the result as JSON
+// object. Returns false, if the variant failed (e.g. the result could not be allocated).
+template<typename T>
+bool benchmark(const char* name, typename Variants<T>::VariantType variant, ResultKind kind,
+	std::size_t itemCount, unsigned threadCount, double memoryLimit, bool first)
+{
+	const std::size_t repetitions(std::max<std::size_t>(1, (1 << 16) >> itemCount));
+
+	std::printf("%s    {\"variant\": \"%s\", \"type\": \"%s\", \"items\": %llu, ",
+		first ? "" : ",\n", name, ItemTraits<T>::name(),
+		static_cast<unsigned long long>(itemCount));
+	if(memoryLimit < estimatedBytes<T>(kind, itemCount))
+	{
+		std::printf("\"error\": \"exceeds memory limit\"}");
+		return false;
+	}
+
+	Measurement measurement;
+	try
+	{
+		std::vector<T> items;
+		for(std::size_t item(0); item < itemCount; ++item)
+		{
+			items.push_back(ItemTraits<T>::create(item));
+		}
+		for(std::size_t repetition(0); repetition < repetitions; ++repetition)
+		{
+			variant(items, threadCount, measurement);
+		}
+	}
+	catch(const std::bad_alloc&)
+	{
+		std::printf("\"error\": \"out of memory\"}");
+		return false;
+	}
+	catch(const std::exception& exception)
+	{
+		std::printf("\"error\": ");
+		printJsonString(exception.what());
+		std::printf("}");
+		return false;
+	}
+
+	const double generateSeconds(measurement.generateSeconds / repetitions);
+	const double releaseSeconds(measurement.releaseSeconds / repetitions);
+	std::printf("\"repetitions\": %llu, \"generateSeconds\": %.9f, \"releaseSeconds\": %.9f, "
+		"\"subsetsPerSecond\": %.1f, \"allocations\": %llu, \"allocatedBytes\": %llu, "
+		"\"peakHeapBytes\": %llu, \"processPeakResidentBytes\": %llu, \"subsetCount\": %llu}",
+		static_cast<unsigned long long>(repetitions), generateSeconds, releaseSeconds,
+		0 < generateSeconds ? measurement.resultCount / generateSeconds : 0.0,
+		measurement.allocations / repetitions, measurement.allocatedBytes / repetitions,
+		measurement.peakHeapBytes, peakResidentBytes(),
+		measurement.resultCount);
+	std::fflush(stdout);
+	return true;
+}
+
+
+// Runs all variants for items of type T from 4 to maxItems items.
+template<typename T>
+void benchmarkType(std::size_t maxItems, unsigned threadCount, double memoryLimit, bool& first)
+{
+	struct Variant
+	{
+		const char* name;
+		typename Variants<T>::VariantType run;
+		ResultKind kind;
+	};
+	const Variant variants[] =
+	{
+		{"recursive", &Variants<T>::recursive, NestedResult},
+		{"references", &Variants<T>::references, ReferencesResult},
+		{"visit", &Variants<T>::visit, NoResult},
+		{"lazy", &Variants<T>::lazy, NoResult},
+		{"flat", &Variants<T>::flat, FlatResult},
+		{"flatParallel", &Variants<T>::flatParallel, FlatResult},
+		{"parallel", &Variants<T>::parallel, NestedResult},
+		{"incremental", &Variants<T>::incremental, IncrementalResult}
+	};
+	const std::size_t variantCount(sizeof(variants) / sizeof(variants[0]));
+	bool allocatable[variantCount];
+	std::fill(allocatable, allocatable + variantCount, true);
+
+	for(std::size_t itemCount(4); itemCount <= maxItems; ++itemCount)
+	{
+		for(std::size_t variant(0); variant < variantCount; ++variant)
+		{
+			// Don't try larger counts, if a variant failed already (e.g. ran out of memory).
+			if(allocatable[variant])
+			{
+				allocatable[variant] = benchmark<T>(variants[variant].name, variants[variant].run,
+					variants[variant].kind, itemCount, threadCount, memoryLimit, first);
+				first = false;
+			}
+		}
+	}
+}
+
+
+int _tmain(int argc, _TCHAR* argv[])
+{
+	const int maxItems(1 < argc ? _ttoi(argv[1]) : 26);
+	const unsigned threadCount(2 < argc ? static_cast<unsigned>(_ttoi(argv[2])) : 0);
+	const int memoryLimitMB(3 < argc ? _ttoi(argv[3]) : 1024);
+	const std::size_t items(static_cast<std::size_t>(std::max(0,
+		std::min<int>(maxItems, static_cast<int>(MaxSubsetItems)))));
+	const double memoryLimit(std::max(0, memoryLimitMB) * 1024.0 * 1024.0);
+
+	std::printf("{\n  \"benchmark\": \"STLSubSets\",\n  \"threads\": %u,\n"
+		"  \"memoryLimitBytes\": %.0f,\n  \"results\": [\n",
+		subsetThreadCount(threadCount, static_cast<unsigned long long>(-1)), memoryLimit);
+	bool first(true);
+	benchmarkType<int>(items, threadCount, memoryLimit, first);
+	benchmarkType<std::string>(items, threadCount, memoryLimit, first);
+	benchmarkType<LargePod>(items, threadCount, memoryLimit, first);
+	std::printf("\n  ]\n}\n");
+	return EXIT_SUCCESS;
+}